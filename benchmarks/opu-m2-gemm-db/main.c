@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <riscv-pk/encoding.h>
+#include <riscv_vector.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "bme.h"
+
+// Double-buffered variant of opu-m2-gemm. C tiles alternate between
+// (m0, m1) and (m2, m3). While the K loop accumulates into one pair,
+// the other pair's finished rows are moved out and the next C tile's
+// rows are moved in, one row per K iteration, so the mvin/mvout traffic
+// overlaps with the maccs.
+
+void i8_mm_scalar(int32_t* c_in, int32_t* c_out, int8_t* at, int8_t* b, size_t M, size_t N, size_t K) {
+  for (size_t i = 0; i < M; i++) {
+    for (size_t j = 0; j < N; j++) {
+      c_out[i*N+j] = c_in[i*N+j];
+      for (size_t k = 0; k < K; k++) {
+        c_out[i*N+j] += at[k*M+i] * b[k*N+j];
+      }
+    }
+  }
+}
+
+// Store row r of the finished pair (mc, md) to c_prev, then load row r
+// of the next C tile into the same pair. Expects e32, m4.
+#define SWAP_ROW(mc, md, c_prev, c_next, r, ml, N)                       \
+  if (c_prev) {                                                          \
+    VMV_VR(v8, r, mc);                                                   \
+    VMV_VR(v12, r, md);                                                  \
+    asm volatile("vse32.v v8, (%0)" : : "r"(&c_prev[r*N]));              \
+    asm volatile("vse32.v v12, (%0)" : : "r"(&c_prev[r*N + ml]));        \
+  }                                                                      \
+  if (c_next) {                                                          \
+    asm volatile("vle32.v v0, (%0)" : : "r"(&c_next[r*N]));              \
+    asm volatile("vle32.v v4, (%0)" : : "r"(&c_next[r*N + ml]));         \
+    VMV_RV(mc, r, v0);                                                   \
+    VMV_RV(md, r, v4);                                                   \
+  }
+
+// Accumulate into (ma, mb) while swapping rows of (mc, md)
+#define DEFINE_I8_M2_LOOP_K(name, ma, mb, mc, md)                                        \
+void name(int8_t* at, int8_t* b, size_t ml, size_t M, size_t N, size_t K,                \
+          int32_t* c_prev, int32_t* c_next) {                                            \
+  size_t r = 0;                                                                          \
+  for (size_t k = 0; k+2 <= K; k+=2) {                                                   \
+    asm volatile("vsetvli zero, %0, e8, m1, ta, ma" : : "r"(ml));                        \
+    asm volatile("vle8.v v16, (%0)" : : "r"(&at[k*M]));                                 \
+    asm volatile("vle8.v v17, (%0)" : : "r"(&b[k*N]));                                  \
+    VOPACC(ma, v17, v16);                                                                \
+    asm volatile("vle8.v v18, (%0)" : : "r"(&b[k*N + ml]));                             \
+    VOPACC(mb, v18, v16);                                                                \
+    asm volatile("vle8.v v19, (%0)" : : "r"(&at[(k+1)*M]));                             \
+    asm volatile("vle8.v v20, (%0)" : : "r"(&b[(k+1)*N]));                              \
+    VOPACC(ma, v20, v19);                                                                \
+    asm volatile("vle8.v v21, (%0)" : : "r"(&b[(k+1)*N + ml]));                         \
+    VOPACC(mb, v21, v19);                                                                \
+    if (r < ml) {                                                                        \
+      asm volatile("vsetvli zero, %0, e32, m4, ta, ma" : : "r"(ml));                     \
+      SWAP_ROW(mc, md, c_prev, c_next, r, ml, N);                                        \
+      r++;                                                                               \
+    }                                                                                    \
+  }                                                                                      \
+  asm volatile("vsetvli zero, %0, e32, m4, ta, ma" : : "r"(ml));                         \
+  for (; r < ml; r++) {                                                                  \
+    SWAP_ROW(mc, md, c_prev, c_next, r, ml, N);                                          \
+  }                                                                                      \
+}
+
+DEFINE_I8_M2_LOOP_K(i8_m2_loop_k_01, m0, m1, m2, m3)
+DEFINE_I8_M2_LOOP_K(i8_m2_loop_k_23, m2, m3, m0, m1)
+
+// Expects e32, m4
+void i32_m2_load_c(int* c, size_t ml, size_t N) {
+  for (size_t r = 0; r < ml; r++) {
+    asm volatile("vle32.v v0, (%0)" : : "r"(&c[r*N]));
+    VMV_RV(m0, r, v0);
+    asm volatile("vle32.v v4, (%0)" : : "r"(&c[r*N + ml]));
+    VMV_RV(m1, r, v4);
+  }
+}
+
+// Requires M % vlenb == 0, N % (2*vlenb) == 0, and even K
+void i8_mm_bme_db(int32_t* c_in, int32_t* c_out, int8_t* at, int8_t* b, size_t M, size_t N, size_t K) {
+  size_t ml;
+  asm volatile("vsetvli %0, zero, e8, m1, ta, ma" : "=r"(ml));
+  size_t npairs = N / (2*ml);
+
+  for (size_t i = 0; i < M; i += ml) {
+    asm volatile("vsetvli zero, %0, e32, m4, ta, ma" : : "r"(ml));
+    i32_m2_load_c(&c_in[i*N], ml, N);
+
+    for (size_t p = 0; p < npairs; p++) {
+      int32_t* c_prev = p > 0 ? &c_out[i*N + (p-1)*2*ml] : NULL;
+      int32_t* c_next = p+1 < npairs ? &c_in[i*N + (p+1)*2*ml] : NULL;
+      if (p % 2 == 0) {
+        i8_m2_loop_k_01(&at[i], &b[p*2*ml], ml, M, N, K, c_prev, c_next);
+      } else {
+        i8_m2_loop_k_23(&at[i], &b[p*2*ml], ml, M, N, K, c_prev, c_next);
+      }
+    }
+
+    // drain the last pair
+    int32_t* c_last = &c_out[i*N + (npairs-1)*2*ml];
+    for (size_t r = 0; r < ml; r++) {
+      if (npairs % 2 == 1) {
+        SWAP_ROW(m0, m1, c_last, (int32_t*)NULL, r, ml, N);
+      } else {
+        SWAP_ROW(m2, m3, c_last, (int32_t*)NULL, r, ml, N);
+      }
+    }
+  }
+}
+
+void i32_init(int* d, size_t s) {
+  for (size_t i = 0; i < s; i++) {
+    d[i] = i + 1;
+  }
+}
+
+void i8_init(int8_t* d, size_t s, int8_t start) {
+  for (size_t i = 0; i < s; i++) {
+    d[i] = start + i;
+  }
+}
+
+int i32_compare(int32_t* a, int32_t* b, size_t m, size_t n) {
+  for (size_t i = 0; i < m; i++) {
+    for (size_t j = 0; j < n; j++) {
+      size_t index = i * n + j;
+      if (a[index] != b[index]) {
+        printf("DIVERGENCE at index (%ld, %ld): 0x%x != 0x%x\n", i, j, a[index], b[index]);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+#define TCM_BASE 0x70000000
+
+#define MIN 64
+#define MAX 128
+#define STEP 32
+#define VL 64
+
+#define M_DIM VL
+#define N_DIM (4*VL)
+
+int32_t C_init[M_DIM*N_DIM];
+int32_t C_bme[M_DIM*N_DIM];
+int32_t C_gold[M_DIM*N_DIM];
+int8_t Ats[M_DIM*MAX];
+int8_t Bs[MAX*N_DIM];
+
+int main(void) {
+  size_t m = M_DIM;
+  size_t n = N_DIM;
+
+  int8_t* B = (int8_t*)TCM_BASE;
+  int8_t* At = (int8_t*)(TCM_BASE + n * MAX);
+  // scalar copy of A, B to avoid D1 coherence delays
+  i8_init(At, m * MAX, 1);
+  i8_init(B, MAX * n, 2);
+  i8_init(Ats, m * MAX, 1);
+  i8_init(Bs, MAX * n, 2);
+  i32_init(C_init, m * n);
+
+  printf("i8 GEMM double-buffered\nvlen = %d;\nwarmup cache:\ndim,ops,cycles,maccs/cycle\n", VL*8);
+  int64_t cyclest1 = read_csr(mcycle);
+  i8_mm_bme_db(C_init, C_bme, At, B, m, n, MAX);
+  asm volatile("fence");
+  int64_t cyclest2 = read_csr(mcycle);
+  int64_t cycles = cyclest2 - cyclest1;
+  int64_t ops = m * n * MAX;
+
+  for (size_t k = MIN; k <= MAX; k += STEP) {
+    i8_mm_scalar(C_init, C_gold, Ats, Bs, m, n, k);
+    cyclest1 = read_csr(mcycle);
+    i8_mm_bme_db(C_init, C_bme, At, B, m, n, k);
+    asm volatile("fence");
+    cyclest2 = read_csr(mcycle);
+
+    // verify against reference
+    int r = i32_compare(C_bme, C_gold, m, n);
+    if (r) {
+      printf("Failure in BME M, N, K = %ld %ld %ld\n", m, n, k);
+      exit(1);
+    }
+
+    // one opmacc covers an ml x ml x 1 outer product
+    cycles = cyclest2 - cyclest1;
+    ops = m * n * k;
+    printf("%ld,%ld,%ld,%ld.%02ld\n", k, ops, cycles,
+      ops / (VL*VL) / cycles, (100 * ops / (VL*VL) / cycles) % 100);
+  }
+  printf("SUCCESS testing mmBME\n");
+  return 0;
+}
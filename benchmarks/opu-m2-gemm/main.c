@@ -76,7 +76,19 @@ void i8_m2_loop_k(int8_t* at, int8_t* b, size_t ml, size_t M, size_t N, size_t K
 }
 
 void i32_m2_store_c(int* c, size_t ml, size_t N) {
-  for (size_t r = 0; r < ml; r++) {
+  size_t r = 0;
+  // at LMUL=8 each mvout moves rows r and r+1 into the register group
+  for (; r+2 <= ml; r += 2) {
+    asm volatile("vsetvli zero, %0, e32, m8, ta, ma" : : "r"(ml));
+    VMV_VR(v8, r, m0);
+    VMV_VR(v16, r, m1);
+    asm volatile("vsetvli zero, %0, e32, m4, ta, ma" : : "r"(ml));
+    asm volatile("vse32.v v8, (%0)" : : "r"(&c[r*N]));
+    asm volatile("vse32.v v12, (%0)" : : "r"(&c[(r+1)*N]));
+    asm volatile("vse32.v v16, (%0)" : : "r"(&c[r*N + ml]));
+    asm volatile("vse32.v v20, (%0)" : : "r"(&c[(r+1)*N + ml]));
+  }
+  for (; r < ml; r++) {
     VMV_VR(v8, r, m0); // move row r of m0 into v0
     asm volatile("vse32.v v8, (%0)" : : "r"(&c[r*N]));
     VMV_VR(v12, r, m1); // move row r of m0 into v0
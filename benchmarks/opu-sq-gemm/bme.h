@@ -53,6 +53,6 @@
 #define OPMVINBCAST(md, vs2) \
   asm volatile(".insn r 0x57, 0x6, 0x59, " md ", x0, " vs2);
 
-// opmvv. f6=b101000, f7=b1010001
+// opmvv. f6=b111001, f7=b1110011 (int8 macc)
 #define VOPACC(md, vs2, vs1) \
-  asm volatile(".insn r 0x57, 0x2, 0x51, " md ", " vs1 ", " vs2);
+  asm volatile(".insn r 0x57, 0x2, 0x73, " md ", " vs1 ", " vs2);
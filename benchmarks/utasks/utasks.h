@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <tuple>
+#include <utility>
 #include <cstddef>
 #include <cassert>
 #include <stdio.h>
@@ -12,6 +14,7 @@
 
 
 class runner_t;
+class ws_pool_t;
 
 class mutex_t { // can't use std::mutex if we don't have pthreads
 public:
@@ -81,46 +84,253 @@ private:
   size_t tail;
 };
 
+// Lock-free size-class allocator over a region, shared by all harts.
+// Every hart keeps private free lists, and blocks freed by another
+// hart go onto the owning hart's remote list, which the owner
+// reclaims in bulk. Blocks are 64B aligned and preceded by a 64B
+// header, so size classes range from 64B to 64KB.
+class slab_allocator_t : public allocator_t {
+public:
+  static const size_t line_bytes = 64;
+  static const size_t n_classes = 11;
+  static const size_t max_harts = 16;
+
+  slab_allocator_t(void* region, size_t size) : tail(0) {
+    uintptr_t aligned = ((uintptr_t)region + line_bytes - 1) & ~(uintptr_t)(line_bytes - 1);
+    base = (uint8_t*)aligned;
+    this->size = size - (aligned - (uintptr_t)region);
+    for (size_t h = 0; h < max_harts; h++) {
+      for (size_t c = 0; c < n_classes; c++) {
+        harts[h].local[c] = nullptr;
+        harts[h].remote[c] = nullptr;
+      }
+    }
+  }
+
+  void* allocate(size_t n) {
+    size_t cls = 0;
+    while ((line_bytes << cls) < n) cls++;
+    if (cls >= n_classes) {
+      PRINTF("illegal allocation size %ld\n", n);
+      exit(1);
+    }
+    size_t hart = current_hart();
+    hart_state_t& h = harts[hart];
+    block_t* b = h.local[cls];
+    if (!b) {
+      b = h.remote[cls].exchange(nullptr, std::memory_order_acquire);
+    }
+    if (b) {
+      h.local[cls] = b->next;
+      return b;
+    }
+
+    size_t bytes = line_bytes + (line_bytes << cls);
+    size_t offset = tail.fetch_add(bytes, std::memory_order_relaxed);
+    if (offset + bytes > size) {
+      PRINTF("slab_allocator_t out of memory\n");
+      exit(1);
+    }
+    header_t* hdr = (header_t*)(base + offset);
+    hdr->hart = hart;
+    hdr->cls = cls;
+    return hdr + 1;
+  }
+
+  void deallocate(void* buf) {
+    if (!buf) return;
+    header_t* hdr = (header_t*)buf - 1;
+    block_t* b = (block_t*)buf;
+    if (hdr->hart == current_hart()) {
+      b->next = harts[hdr->hart].local[hdr->cls];
+      harts[hdr->hart].local[hdr->cls] = b;
+    } else {
+      std::atomic<block_t*>& remote = harts[hdr->hart].remote[hdr->cls];
+      block_t* head = remote.load(std::memory_order_relaxed);
+      do {
+        b->next = head;
+      } while (!remote.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_relaxed));
+    }
+  }
+
+private:
+  struct alignas(64) header_t {
+    size_t hart;
+    size_t cls;
+  };
+  struct block_t {
+    block_t* next;
+  };
+  struct alignas(64) hart_state_t {
+    block_t* local[n_classes];
+    std::atomic<block_t*> remote[n_classes];
+  };
+
+  size_t current_hart() {
+    size_t hart = read_csr(mhartid);
+    if (hart >= max_harts) {
+      PRINTF("slab_allocator_t unsupported hart\n");
+      exit(1);
+    }
+    return hart;
+  }
+
+  hart_state_t harts[max_harts];
+  uint8_t* base;
+  size_t size;
+  alignas(64) std::atomic<size_t> tail;
+};
+
+#ifndef UTASKS_CLINT_BASE
+#define UTASKS_CLINT_BASE (0x2000000)
+#endif
+
+// How a hart waits when it finds no work. Each empty poll is followed by
+// a run of pause hints that doubles from min_pause up to max_pause, and
+// after sleep_after consecutive empty polls a runner sleeps in wfi until
+// one of its tasks is notified. The defaults spin without backing off
+class backoff_t {
+public:
+  backoff_t(size_t min_pause = 0, size_t max_pause = 0, size_t sleep_after = 0) :
+    min_pause(min_pause), max_pause(max_pause), sleep_after(sleep_after) { }
+
+  // Returns the length of the next run of pauses
+  size_t pause(size_t n) const {
+    for (size_t i = 0; i < n; i++) {
+      asm volatile(".insn i 0x0F, 0, x0, x0, 0x010"); // Zihintpause pause
+    }
+    size_t next = n ? 2 * n : min_pause;
+    return (next > max_pause) ? max_pause : next;
+  }
+
+  size_t min_pause;
+  size_t max_pause;
+  size_t sleep_after;
+};
+
+// Scheduling state of a task owned by a ws_pool_t
+enum task_sched_state_t {
+  TASK_IDLE,     // no known work
+  TASK_QUEUED,   // in its home runner's deque
+  TASK_MAILED,   // notified from another hart, claimable by any runner
+  TASK_RUNNING,
+  TASK_RERUN,    // notified while running
+  TASK_FINISHED
+};
+
 class alignas(64) task_t {
   friend class runner_t;
+  friend class ws_pool_t;
 public:
-  task_t() : may_finish(false) { }
-  void set_may_finish() { may_finish = true; }
+  task_t() : home(nullptr), sched_state(TASK_IDLE), may_finish(false) { }
+  void set_may_finish() { may_finish = true; notify(); }
   bool __attribute__ ((noinline)) is_finished() { return may_finish && !has_work(); }
-  void wait_for_finished() { while (!this->is_finished()) { }; }
+  void wait_for_finished(const backoff_t& backoff = backoff_t()) {
+    size_t n = backoff.min_pause;
+    while (!this->is_finished()) { n = backoff.pause(n); };
+  }
   virtual void propagate_finished() = 0;
   virtual void assign_runner(runner_t* runner) { };
+  // Signal that this task may have new work. Wakes a sleeping home runner,
+  // and with a ws_pool_t makes the task ready
+  void notify();
 
 private:
   virtual void run() = 0;
   virtual bool has_work() = 0;
+  runner_t* home;
+  std::atomic<int> sched_state;
 protected:
   bool may_finish;
 };
 
+// Chase-Lev work-stealing deque of tasks. Only the owning runner may
+// push or pop, any hart may steal
+class alignas(64) ws_deque_t {
+public:
+  static const int64_t capacity = 64;
+  ws_deque_t() : top(0), bottom(0) { }
+
+  void push(task_t* t) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    if (b - top.load(std::memory_order_acquire) >= capacity) {
+      PRINTF("ws_deque_t overflow\n");
+      exit(1);
+    }
+    slots[b & (capacity-1)].store(t, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  task_t* pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    task_t* r = slots[b & (capacity-1)].load(std::memory_order_relaxed);
+    if (t == b) { // last entry, race against stealers
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        r = nullptr;
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return r;
+  }
+
+  bool empty() {
+    return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+  }
+
+  task_t* steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    task_t* r = slots[t & (capacity-1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+    return r;
+  }
+
+private:
+  alignas(64) std::atomic<int64_t> top;
+  alignas(64) std::atomic<int64_t> bottom;
+  std::atomic<task_t*> slots[capacity];
+};
+
+// head and tail are kept on separate cache lines
 class circular_buffer_pointers_t {
 public:
   circular_buffer_pointers_t() : head_wide(0), tail_wide(0), size(0) { }
   size_t head_wide;
+  size_t pad0[7];
   size_t tail_wide;
+  size_t pad1[7];
   size_t size;
 };
 
+// With spsc, the buffer must have exactly one producer and one consumer
+// task. The producer owns tail_wide and the consumer head_wide, each side
+// caches the other's index, and size is unused, so a push or pop costs
+// at most one store and one load instead of two AMOs
 template <typename T>
 class alignas(64) circular_buffer_t {
 public:
-  circular_buffer_t(size_t capacity, void* buffer, circular_buffer_pointers_t* pointers) : buffer((T*)buffer), capacity(capacity), pointers(pointers) {
+  circular_buffer_t(size_t capacity, void* buffer, circular_buffer_pointers_t* pointers, bool spsc = false) : buffer((T*)buffer), capacity(capacity), pointers(pointers), spsc(spsc), cached_head(0), cached_tail(0) {
     if (capacity < 4 || (capacity & (capacity-1)) != 0) {
       PRINTF("Illegal capacity %ld\n", capacity);
       exit(1);
     }
     mask = capacity - 1;
   }
-  ~circular_buffer_t() {
-    delete[] buffer;
-  }
+  // buffer and pointers are owned by the allocator that provided them
+  ~circular_buffer_t() { }
 
   std::pair<T*, size_t> push(size_t n) {
+    if (spsc) return spsc_push(n);
     size_t tail_wide_read, size_read;
     size_t mask = this->mask;
     asm volatile("amoadd.d %[rd], %[incr], (%[addr])\n" : [rd]"=r"(tail_wide_read) : [incr]"r"(n), [addr]"r"(&pointers->tail_wide));
@@ -136,6 +346,7 @@ public:
   }
 
   std::pair<T*, size_t> pop(size_t n) {
+    if (spsc) return spsc_pop(n);
     size_t head_wide_read, size_read;
     size_t mask = this->mask;
     asm volatile("amoadd.d %[rd], %[incr], (%[addr])\n" : [rd]"=r"(head_wide_read) : [incr]"r"(n)     , [addr]"r"(&pointers->head_wide));
@@ -149,12 +360,51 @@ public:
     return std::make_pair(buffer + head, r);
   }
 
-  bool busy() { return pointers->size != 0; }
+  bool busy() {
+    if (spsc) {
+      return __atomic_load_n(&pointers->tail_wide, __ATOMIC_ACQUIRE) != __atomic_load_n(&pointers->head_wide, __ATOMIC_RELAXED);
+    }
+    return pointers->size != 0;
+  }
 
   T* buffer;
   size_t mask;
   size_t capacity;
   circular_buffer_pointers_t* pointers;
+  bool spsc;
+
+private:
+  std::pair<T*, size_t> spsc_push(size_t n) {
+    size_t tail_wide = pointers->tail_wide + n;
+    if (n) __atomic_store_n(&pointers->tail_wide, tail_wide, __ATOMIC_RELEASE);
+    size_t tail = tail_wide & mask;
+    size_t limit = capacity - tail;
+    size_t remaining_capacity = capacity - (tail_wide - cached_head);
+    if (remaining_capacity < limit) { // the cached head may be stale
+      cached_head = __atomic_load_n(&pointers->head_wide, __ATOMIC_ACQUIRE);
+      remaining_capacity = capacity - (tail_wide - cached_head);
+    }
+    size_t r = (remaining_capacity > limit) ? limit : remaining_capacity;
+    return std::make_pair(buffer + tail, r);
+  }
+
+  std::pair<T*, size_t> spsc_pop(size_t n) {
+    size_t head_wide = pointers->head_wide + n;
+    if (n) __atomic_store_n(&pointers->head_wide, head_wide, __ATOMIC_RELEASE);
+    size_t head = head_wide & mask;
+    size_t limit = capacity - head;
+    size_t available = cached_tail - head_wide;
+    if (available < limit) { // the cached tail may be stale
+      cached_tail = __atomic_load_n(&pointers->tail_wide, __ATOMIC_ACQUIRE);
+      available = cached_tail - head_wide;
+    }
+    size_t r = (available > limit) ? limit : available;
+    return std::make_pair(buffer + head, r);
+  }
+
+  // producer's copy of head_wide, consumer's copy of tail_wide
+  alignas(64) size_t cached_head;
+  alignas(64) size_t cached_tail;
 };
 
 template <typename T, typename U>
@@ -166,6 +416,12 @@ public:
                                              circular_buffer_t<U>* const sink,
                                              circular_buffer_pointers_t* sink_pointers,
                                              size_t n) {
+    if (source->spsc || sink->spsc) { // each side pays only for its own synchronization
+      std::pair<T*, size_t> pop = source->pop(n);
+      std::pair<U*, size_t> push = sink->push(n);
+      size_t r = (push.second > pop.second) ? pop.second : push.second;
+      return std::make_tuple(pop.first, push.first, r);
+    }
     size_t sink_tail_wide_read, sink_size_read;
     size_t source_head_wide_read, source_size_read;
     asm volatile("amoadd.d %[rd], %[incr], (%[addr])\n" : [rd]"=r"(sink_tail_wide_read)   : [incr]"r"(n)     , [addr]"r"(&sink_pointers->tail_wide));
@@ -208,19 +464,37 @@ template <typename T> class sink_t;
 template <typename T> class source_t;
 
 class runner_t {
+  friend class task_t;
+  friend class ws_pool_t;
 public:
-  runner_t(size_t id, allocator_t* allocator) : id(id), task_count(0), allocator(allocator) { };
+  // With a pool, tasks become ready when notified rather than being polled,
+  // and idle runners steal ready tasks from the others. add_task then only
+  // sets a task's affinity
+  runner_t(size_t id, allocator_t* allocator, ws_pool_t* pool = nullptr);
   void run() {
+    hart = read_csr(mhartid);
+    if (pool) {
+      run_stealing();
+    }
     while (1) {
       task_t* scheduled_task = schedule_task();
       if (scheduled_task) {
 	scheduled_task->run();
+	idle_polls = 0;
+      } else {
+	wait_for_work();
       }
     }
   }
 
-  void add_task(task_t* task) {
+  // Call before run() and before any task is added, since notify() reads
+  // it from other harts
+  void set_backoff(const backoff_t& backoff) { this->backoff = backoff; }
+
+  void add_task(task_t* task);
+  void add_static_task(task_t* task) {
     task->assign_runner(this);
+    task->home = this;
     task_lock.lock();
     tasks.push_back(task);
     task_count++;
@@ -232,6 +506,13 @@ public:
   allocator_t* get_allocator() { return allocator; }
 
 private:
+  void run_stealing();
+  void execute(task_t* task);
+  void requeue(task_t* task);
+  void wait_for_work();
+  bool has_ready_work();
+  void wake();
+
   task_t* schedule_task() {
     task_lock.lock();
     for (auto& t : tasks) {
@@ -246,38 +527,256 @@ private:
         (*it)->propagate_finished();
 	it = tasks.erase(it);
 	task_count--;
+      } else {
+        it++;
       }
-      it++;
     }
     task_lock.unlock();
     return nullptr;
   }
 
   size_t id;
+  size_t hart;
   mutex_t task_lock;
   std::atomic<size_t> task_count;
   std::list<task_t*> tasks;
   allocator_t* allocator;
+  ws_pool_t* pool;
+  ws_deque_t deque;
+  backoff_t backoff;
+  size_t idle_polls;
+  size_t pause_len;
+  size_t mail_scan;
+  alignas(64) std::atomic<bool> sleeping;
 };
 
+// Runners sharing a pool steal ready tasks from each other
+class ws_pool_t {
+  friend class runner_t;
+  friend class task_t;
+public:
+  static const size_t max_runners = 16;
+  static const size_t max_tasks = 64;
+  static const size_t max_harts = 16;
+  ws_pool_t() : n_runners(0), n_tasks(0) {
+    for (size_t i = 0; i < max_runners; i++) runners[i] = nullptr;
+    for (size_t i = 0; i < max_harts; i++) hart_runners[i] = nullptr;
+  }
+
+private:
+  // runner ids index the pool, and may register in any order
+  void add_runner(runner_t* runner) {
+    runners[runner->id].store(runner, std::memory_order_release);
+    size_t n = n_runners.load();
+    while (n <= runner->id && !n_runners.compare_exchange_weak(n, runner->id + 1)) { }
+  }
+
+  void add_task(task_t* task) {
+    size_t i = n_tasks.load();
+    if (i == max_tasks) {
+      PRINTF("ws_pool_t too many tasks\n");
+      exit(1);
+    }
+    tasks[i] = task;
+    n_tasks.store(i + 1, std::memory_order_release);
+  }
+
+  runner_t* current_runner() {
+    size_t hart = read_csr(mhartid);
+    return hart < max_harts ? hart_runners[hart].load(std::memory_order_relaxed) : nullptr;
+  }
+
+  // Mailed tasks with affinity to this runner first, then any mailed task,
+  // then steal from the other runners' deques. Mailed tasks are scanned
+  // round-robin, so a ready task is never passed over indefinitely
+  bool has_mailed() {
+    size_t n = n_tasks.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; i++) {
+      if (tasks[i]->sched_state.load(std::memory_order_relaxed) == TASK_MAILED) return true;
+    }
+    return false;
+  }
+
+  task_t* find_work(runner_t* self) {
+    size_t n = n_tasks.load(std::memory_order_acquire);
+    for (size_t pass = 0; pass < 2; pass++) {
+      for (size_t k = 0; k < n; k++) {
+        size_t i = (self->mail_scan + k) % n;
+        task_t* t = tasks[i];
+        int s = TASK_MAILED;
+        if ((t->home == self) == (pass == 0) &&
+            t->sched_state.load(std::memory_order_relaxed) == TASK_MAILED &&
+            t->sched_state.compare_exchange_strong(s, TASK_RUNNING)) {
+          self->mail_scan = i + 1;
+          return t;
+        }
+      }
+    }
+    size_t nr = n_runners.load(std::memory_order_acquire);
+    for (size_t i = 1; i < nr; i++) {
+      runner_t* victim = runners[(self->id + i) % nr].load(std::memory_order_acquire);
+      task_t* t = victim ? victim->deque.steal() : nullptr;
+      if (t) return t;
+    }
+    return nullptr;
+  }
+
+  std::atomic<runner_t*> runners[max_runners];
+  std::atomic<size_t> n_runners;
+  task_t* tasks[max_tasks];
+  std::atomic<size_t> n_tasks;
+  std::atomic<runner_t*> hart_runners[max_harts];
+};
+
+inline runner_t::runner_t(size_t id, allocator_t* allocator, ws_pool_t* pool) : id(id), hart(0), task_count(0), allocator(allocator), pool(pool), idle_polls(0), pause_len(0), mail_scan(0), sleeping(false) {
+  if (pool) {
+    if (id >= ws_pool_t::max_runners) {
+      PRINTF("ws_pool_t too many runners\n");
+      exit(1);
+    }
+    pool->add_runner(this);
+  }
+}
+
+inline void runner_t::add_task(task_t* task) {
+  if (!pool) {
+    add_static_task(task);
+    return;
+  }
+  task->assign_runner(this);
+  task->home = this;
+  task_count++;
+  pool->add_task(task);
+  task->notify();
+}
+
+inline void runner_t::run_stealing() {
+  size_t hart = read_csr(mhartid);
+  if (hart < ws_pool_t::max_harts) pool->hart_runners[hart].store(this);
+  while (1) {
+    task_t* t = deque.pop();
+    if (!t) t = pool->find_work(this);
+    if (t) {
+      execute(t);
+      idle_polls = 0;
+    } else {
+      wait_for_work();
+    }
+  }
+}
+
+// Only one runner holds a task in TASK_RUNNING, so a pipe stage never
+// runs on two harts at once
+inline void runner_t::execute(task_t* task) {
+  task->sched_state.store(TASK_RUNNING);
+  if (task->has_work()) {
+    task->run();
+  }
+  if (task->is_finished()) {
+    task->sched_state.store(TASK_FINISHED);
+    task->propagate_finished();
+    task->home->task_count--;
+  } else if (task->has_work()) {
+    requeue(task);
+  } else {
+    int s = TASK_RUNNING;
+    if (!task->sched_state.compare_exchange_strong(s, TASK_IDLE)) {
+      requeue(task); // notified while running
+    }
+  }
+}
+
+// Tasks still ready after running are mailed rather than pushed back on
+// the deque, where pop() would hand them straight back. A stage blocked
+// on a full output ring then waits behind the deque and the other mailed
+// tasks, which include the consumer that drains it
+inline void runner_t::requeue(task_t* task) {
+  task->sched_state.store(TASK_MAILED);
+}
+
+// Called after an empty poll. Backs off with pauses, then sleeps until
+// notified. sleeping is published before the final check for work, and
+// notify() checks it after publishing the work, so a wakeup is never
+// lost. The IPI stays pending, so one sent before the wfi still wakes it
+inline void runner_t::wait_for_work() {
+  if (idle_polls == 0) pause_len = backoff.min_pause;
+  idle_polls++;
+  if (backoff.sleep_after == 0 || idle_polls < backoff.sleep_after) {
+    pause_len = backoff.pause(pause_len);
+    return;
+  }
+  sleeping.store(true);
+  if (!has_ready_work()) {
+    clear_csr(mstatus, MSTATUS_MIE);
+    set_csr(mie, MIP_MSIP);
+    asm volatile("wfi");
+  }
+  sleeping.store(false);
+  *(volatile uint32_t*)(UTASKS_CLINT_BASE + 4 * hart) = 0;
+  idle_polls = 0;
+}
+
+inline bool runner_t::has_ready_work() {
+  if (pool) return !deque.empty() || pool->has_mailed();
+  task_lock.lock();
+  bool r = false;
+  for (auto& t : tasks) r = r || t->has_work() || t->is_finished();
+  task_lock.unlock();
+  return r;
+}
+
+inline void runner_t::wake() {
+  if (backoff.sleep_after == 0) return; // this runner never sleeps
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    *(volatile uint32_t*)(UTASKS_CLINT_BASE + 4 * hart) = 1;
+  }
+}
+
+inline void task_t::notify() {
+  if (!home) return;
+  home->wake();
+  if (!home->pool) return;
+  runner_t* self = home->pool->current_runner();
+  while (1) {
+    int s = sched_state.load(std::memory_order_acquire);
+    if (s == TASK_IDLE) {
+      bool local = self == home;
+      if (sched_state.compare_exchange_weak(s, local ? TASK_QUEUED : TASK_MAILED)) {
+        if (local) home->deque.push(this);
+        return;
+      }
+    } else if (s == TASK_RUNNING) {
+      if (sched_state.compare_exchange_weak(s, TASK_RERUN)) return;
+    } else {
+      return;
+    }
+  }
+}
+
 
 template <typename T>
 class sink_t : virtual public task_t {
   friend class source_t<T>;
 public:
-  sink_t(size_t buffer_size) : buffer_size(buffer_size), buffer(nullptr) { }
+  // spsc selects the single-producer ring for the edge into this sink
+  sink_t(size_t buffer_size, bool spsc = false) : buffer_size(buffer_size), spsc(spsc), buffer(nullptr) { }
   ~sink_t() {
+    if (!buffer) return;
+    circular_buffer_pointers_t* pointers = buffer->pointers;
+    delete buffer;
+    runner->get_allocator()->deallocate(pointers);
     runner->get_allocator()->deallocate(buffer_data);
-    runner->get_allocator()->deallocate(buffer);
   }
   void assign_runner(runner_t* runner) {
     this->runner = runner;
     void* pointers_buff = runner->get_allocator()->allocate(sizeof(circular_buffer_pointers_t));
     circular_buffer_pointers_t* pointers = new (pointers_buff) circular_buffer_pointers_t;
     buffer_data = runner->get_allocator()->allocate(buffer_size * sizeof(T));
-    buffer = new circular_buffer_t<T>(buffer_size, buffer_data, pointers);
+    buffer = new circular_buffer_t<T>(buffer_size, buffer_data, pointers, spsc);
   }
   size_t buffer_size;
+  bool spsc;
   alignas(64) circular_buffer_t<T>* buffer;
 private:
   runner_t* runner;
@@ -314,7 +813,7 @@ protected:
 template <typename T, typename U>
 class pipe_task_t : public source_t<U>, public sink_t<T> {
 public:
-  pipe_task_t(size_t buffer_size, size_t max_chunk) : max_chunk(max_chunk), sink_t<T>(buffer_size) { }
+  pipe_task_t(size_t buffer_size, size_t max_chunk, bool spsc = false) : max_chunk(max_chunk), sink_t<T>(buffer_size, spsc) { }
   bool has_work() { return this->buffer->busy(); }
   virtual size_t kernel(T* in, U* out, size_t n) = 0;
 private:
@@ -345,6 +844,7 @@ private:
 	r = circular_buffer_helper_t<T, U>::push_pop(buffer, source_pointers,
                                                      next_buffer, next_pointers,
                                                      completed);
+	if (completed) this->next->notify();
 	input = std::get<0>(r);
 	output = std::get<1>(r);
 	n = std::get<2>(r);
@@ -374,6 +874,39 @@ private:
   size_t max_chunk;
 };
 
+// Runs a chain of kernel functors as a single pipe stage, so values stay
+// in registers between them instead of going through a ring buffer.
+// Strip describes one strip-mined vector: elem_t, vec_t, setvl(n),
+// load(in, vl) and store(out, v, vl). Each stage is called as
+// v = stage(v, vl), in order
+template <typename Strip, typename... Stages>
+class fused_pipe_task_t : public pipe_task_t<typename Strip::elem_t, typename Strip::elem_t> {
+public:
+  typedef typename Strip::elem_t T;
+  typedef typename Strip::vec_t V;
+  static const size_t unroll = 4;
+  fused_pipe_task_t(std::tuple<Stages...> stages, size_t buffer_size, size_t max_chunk, bool spsc = false) :
+    pipe_task_t<T, T>(buffer_size, max_chunk, spsc), stages(stages) { }
+  size_t kernel(T* in, T* out, size_t n) {
+    size_t done = 0;
+    for (size_t i = 0; i < unroll && done < n; i++) {
+      size_t vl = Strip::setvl(n - done);
+      V v = Strip::load(in + done, vl);
+      v = apply(v, vl, std::index_sequence_for<Stages...>());
+      Strip::store(out + done, v, vl);
+      done += vl;
+    }
+    return done;
+  }
+private:
+  template <size_t... I>
+  V apply(V v, size_t vl, std::index_sequence<I...>) {
+    ((v = std::get<I>(stages)(v, vl)), ...);
+    return v;
+  }
+  std::tuple<Stages...> stages;
+};
+
 template <typename T>
 class source_task_t : public source_t<T> {
 public:
@@ -401,6 +934,7 @@ private:
       }
       asm volatile("fence");
       push = next_buffer->push(completed);
+      if (completed) this->next->notify();
       output = push.first;
       n = push.second;
       if (completed == 0) break;
@@ -412,7 +946,7 @@ private:
 template <typename T>
 class sink_task_t : public sink_t<T> {
 public:
-  sink_task_t(size_t buffer_size, size_t max_chunk) : max_chunk(max_chunk), sink_t<T>(buffer_size) { }
+  sink_task_t(size_t buffer_size, size_t max_chunk, bool spsc = false) : max_chunk(max_chunk), sink_t<T>(buffer_size, spsc) { }
   bool has_work() { return this->buffer->busy(); }
   virtual size_t kernel(T* in, size_t n) = 0;
 private:
@@ -0,0 +1,241 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// FP sum reduction latency benchmark
+//--------------------------------------------------------------------------
+//
+// Times chains of dependent vfredosum/vfredusum (and their widening
+// forms) across VL, so ordered and unordered reduction latency can be
+// compared directly. Inputs are small integers, so both orders give
+// exact sums and the results are checked against a scalar reference.
+//
+// The directed checks that follow cover what the timed runs cannot:
+// fractional inputs, whose unordered sums may round differently from a
+// sequential sum and are checked against an error bound, masked-off
+// elements, an all-inactive mask, signed zeros and NaN propagation.
+// Spike sums vfredusum in order, so these stand in for the generated
+// vfredusum/vfwredusum tests that build-tests.sh drops.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <riscv_vector.h>
+#include "util.h"
+
+#define MAX_ELEMS (1024)
+#define REPS (16)
+
+float  input_f32[MAX_ELEMS];
+double input_f64[MAX_ELEMS];
+
+typedef enum { OSUM, USUM } order_t;
+
+size_t time_f32(order_t order, size_t vl, float* result) {
+  vfloat32m8_t v = __riscv_vle32_v_f32m8(input_f32, vl);
+  vfloat32m1_t acc = __riscv_vfmv_s_f_f32m1(0.0f, 1);
+  size_t start = read_csr(mcycle);
+  for (size_t r = 0; r < REPS; r++) {
+    if (order == OSUM) acc = __riscv_vfredosum_vs_f32m8_f32m1(v, acc, vl);
+    else               acc = __riscv_vfredusum_vs_f32m8_f32m1(v, acc, vl);
+  }
+  *result = __riscv_vfmv_f_s_f32m1_f32(acc);
+  return read_csr(mcycle) - start;
+}
+
+size_t time_f64(order_t order, size_t vl, double* result) {
+  vfloat64m8_t v = __riscv_vle64_v_f64m8(input_f64, vl);
+  vfloat64m1_t acc = __riscv_vfmv_s_f_f64m1(0.0, 1);
+  size_t start = read_csr(mcycle);
+  for (size_t r = 0; r < REPS; r++) {
+    if (order == OSUM) acc = __riscv_vfredosum_vs_f64m8_f64m1(v, acc, vl);
+    else               acc = __riscv_vfredusum_vs_f64m8_f64m1(v, acc, vl);
+  }
+  *result = __riscv_vfmv_f_s_f64m1_f64(acc);
+  return read_csr(mcycle) - start;
+}
+
+size_t time_wf32(order_t order, size_t vl, double* result) {
+  vfloat32m8_t v = __riscv_vle32_v_f32m8(input_f32, vl);
+  vfloat64m1_t acc = __riscv_vfmv_s_f_f64m1(0.0, 1);
+  size_t start = read_csr(mcycle);
+  for (size_t r = 0; r < REPS; r++) {
+    if (order == OSUM) acc = __riscv_vfwredosum_vs_f32m8_f64m1(v, acc, vl);
+    else               acc = __riscv_vfwredusum_vs_f32m8_f64m1(v, acc, vl);
+  }
+  *result = __riscv_vfmv_f_s_f64m1_f64(acc);
+  return read_csr(mcycle) - start;
+}
+
+double reference(size_t vl) {
+  double sum = 0;
+  for (size_t i = 0; i < vl; i++) sum += input_f64[i];
+  return sum * REPS;
+}
+
+int check(const char* name, size_t vl, double got) {
+  if (got != reference(vl)) {
+    printf("%s vl=%ld mismatch %ld != %ld\n", name, vl, (long)got, (long)reference(vl));
+    return 1;
+  }
+  return 0;
+}
+
+// Any summation order of n terms is within (n-1)*eps*sum|x| of the
+// exact sum, and so is the sequential reference
+int check_bound(const char* name, size_t vl, double got, double ref, double abs_sum, double eps) {
+  double err = got > ref ? got - ref : ref - got;
+  if (err > 2 * vl * eps * abs_sum) {
+    printf("%s vl=%ld error %ld ulps of the sum bound\n", name, vl, (long)(err / (eps * abs_sum)));
+    return 1;
+  }
+  return 0;
+}
+
+uint32_t bits_f32(float f) { uint32_t b; memcpy(&b, &f, sizeof(b)); return b; }
+uint64_t bits_f64(double f) { uint64_t b; memcpy(&b, &f, sizeof(b)); return b; }
+float f32_bits(uint32_t b) { float f; memcpy(&f, &b, sizeof(f)); return f; }
+double f64_bits(uint64_t b) { double f; memcpy(&f, &b, sizeof(f)); return f; }
+
+int expect_bits(const char* name, uint64_t got, uint64_t want) {
+  if (got != want) {
+    printf("%s got %lx expected %lx\n", name, got, want);
+    return 1;
+  }
+  return 0;
+}
+
+int directed_f32(size_t vl) {
+  int errors = 0;
+  double ref = 0, abs_sum = 0, ref_m = 0, abs_sum_m = 0;
+  for (size_t i = 0; i < vl; i++) {
+    double x = input_f32[i];
+    ref += x;
+    abs_sum += x < 0 ? -x : x;
+    if (i % 3 == 0) {
+      ref_m += x;
+      abs_sum_m += x < 0 ? -x : x;
+    }
+  }
+
+  vfloat32m8_t v = __riscv_vle32_v_f32m8(input_f32, vl);
+  vfloat32m1_t zero = __riscv_vfmv_s_f_f32m1(0.0f, 1);
+  vbool4_t every3 = __riscv_vmseq_vx_u32m8_b4(__riscv_vremu_vx_u32m8(__riscv_vid_v_u32m8(vl), 3, vl), 0, vl);
+
+  float got = __riscv_vfmv_f_s_f32m1_f32(__riscv_vfredusum_vs_f32m8_f32m1(v, zero, vl));
+  errors += check_bound("vfredusum.e32", vl, got, ref, abs_sum, 1.0 / (1 << 23));
+  got = __riscv_vfmv_f_s_f32m1_f32(__riscv_vfredusum_vs_f32m8_f32m1_m(every3, v, zero, vl));
+  errors += check_bound("vfredusum.e32 masked", vl, got, ref_m, abs_sum_m, 1.0 / (1 << 23));
+  double wgot = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfwredusum_vs_f32m8_f64m1(v, __riscv_vfmv_s_f_f64m1(0.0, 1), vl));
+  errors += check_bound("vfwredusum.e32", vl, wgot, ref, abs_sum, 1.0 / (1ull << 52));
+
+  // With no active element the scalar comes back untouched
+  vfloat32m1_t acc = __riscv_vfmv_s_f_f32m1(f32_bits(0x80000000), 1);
+  got = __riscv_vfmv_f_s_f32m1_f32(__riscv_vfredusum_vs_f32m8_f32m1_m(__riscv_vmclr_m_b4(vl), v, acc, vl));
+  errors += expect_bits("vfredusum.e32 no active", bits_f32(got), 0x80000000);
+
+  // -0 is the additive identity, so all -0 sums to -0
+  vfloat32m8_t nzero = __riscv_vfmv_v_f_f32m8(f32_bits(0x80000000), vl);
+  got = __riscv_vfmv_f_s_f32m1_f32(__riscv_vfredusum_vs_f32m8_f32m1(nzero, acc, vl));
+  errors += expect_bits("vfredusum.e32 -0", bits_f32(got), 0x80000000);
+
+  // A NaN anywhere gives the canonical NaN
+  vfloat32m8_t nan = __riscv_vfslide1up_vf_f32m8(v, f32_bits(0x7fc00000), vl);
+  got = __riscv_vfmv_f_s_f32m1_f32(__riscv_vfredusum_vs_f32m8_f32m1(nan, zero, vl));
+  errors += expect_bits("vfredusum.e32 NaN", bits_f32(got), 0x7fc00000);
+  return errors;
+}
+
+int directed_f64(size_t vl) {
+  int errors = 0;
+  double ref = 0, abs_sum = 0, ref_m = 0, abs_sum_m = 0;
+  for (size_t i = 0; i < vl; i++) {
+    double x = input_f64[i];
+    ref += x;
+    abs_sum += x < 0 ? -x : x;
+    if (i % 3 == 0) {
+      ref_m += x;
+      abs_sum_m += x < 0 ? -x : x;
+    }
+  }
+
+  vfloat64m8_t v = __riscv_vle64_v_f64m8(input_f64, vl);
+  vfloat64m1_t zero = __riscv_vfmv_s_f_f64m1(0.0, 1);
+  vbool8_t every3 = __riscv_vmseq_vx_u64m8_b8(__riscv_vremu_vx_u64m8(__riscv_vid_v_u64m8(vl), 3, vl), 0, vl);
+
+  double got = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfredusum_vs_f64m8_f64m1(v, zero, vl));
+  errors += check_bound("vfredusum.e64", vl, got, ref, abs_sum, 1.0 / (1ull << 52));
+  got = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfredusum_vs_f64m8_f64m1_m(every3, v, zero, vl));
+  errors += check_bound("vfredusum.e64 masked", vl, got, ref_m, abs_sum_m, 1.0 / (1ull << 52));
+
+  vfloat64m1_t acc = __riscv_vfmv_s_f_f64m1(f64_bits(0x8000000000000000ull), 1);
+  got = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfredusum_vs_f64m8_f64m1_m(__riscv_vmclr_m_b8(vl), v, acc, vl));
+  errors += expect_bits("vfredusum.e64 no active", bits_f64(got), 0x8000000000000000ull);
+
+  vfloat64m8_t nzero = __riscv_vfmv_v_f_f64m8(f64_bits(0x8000000000000000ull), vl);
+  got = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfredusum_vs_f64m8_f64m1(nzero, acc, vl));
+  errors += expect_bits("vfredusum.e64 -0", bits_f64(got), 0x8000000000000000ull);
+
+  vfloat64m8_t nan = __riscv_vfslide1up_vf_f64m8(v, f64_bits(0x7ff8000000000000ull), vl);
+  got = __riscv_vfmv_f_s_f64m1_f64(__riscv_vfredusum_vs_f64m8_f64m1(nan, zero, vl));
+  errors += expect_bits("vfredusum.e64 NaN", bits_f64(got), 0x7ff8000000000000ull);
+  return errors;
+}
+
+int main( int argc, char* argv[] )
+{
+  for (size_t i = 0; i < MAX_ELEMS; i++) {
+    input_f32[i] = (float)(i % 7);
+    input_f64[i] = (double)(i % 7);
+  }
+
+  size_t vlmax_e32 = __riscv_vsetvlmax_e32m8();
+  size_t vlmax_e64 = __riscv_vsetvlmax_e64m8();
+  if (vlmax_e32 > MAX_ELEMS) vlmax_e32 = MAX_ELEMS;
+  if (vlmax_e64 > MAX_ELEMS) vlmax_e64 = MAX_ELEMS;
+
+  int errors = 0;
+  float f32;
+  double f64;
+
+  // warm up the caches and the instruction path
+  time_f32(OSUM, vlmax_e32, &f32);
+  time_f32(USUM, vlmax_e32, &f32);
+
+  printf("type,vl,ordered,unordered\n");
+  for (size_t vl = 1; vl <= vlmax_e32; vl *= 2) {
+    size_t osum = time_f32(OSUM, vl, &f32);
+    errors += check("vfredosum.e32", vl, f32);
+    size_t usum = time_f32(USUM, vl, &f32);
+    errors += check("vfredusum.e32", vl, f32);
+    printf("e32,%ld,%ld,%ld\n", vl, osum / REPS, usum / REPS);
+  }
+  for (size_t vl = 1; vl <= vlmax_e64; vl *= 2) {
+    size_t osum = time_f64(OSUM, vl, &f64);
+    errors += check("vfredosum.e64", vl, f64);
+    size_t usum = time_f64(USUM, vl, &f64);
+    errors += check("vfredusum.e64", vl, f64);
+    printf("e64,%ld,%ld,%ld\n", vl, osum / REPS, usum / REPS);
+  }
+  for (size_t vl = 1; vl <= vlmax_e32; vl *= 2) {
+    size_t osum = time_wf32(OSUM, vl, &f64);
+    errors += check("vfwredosum.e32", vl, f64);
+    size_t usum = time_wf32(USUM, vl, &f64);
+    errors += check("vfwredusum.e32", vl, f64);
+    printf("e32w,%ld,%ld,%ld\n", vl, osum / REPS, usum / REPS);
+  }
+
+  // Fractional inputs of both signs and a wide range of magnitudes
+  uint32_t seed = 1;
+  for (size_t i = 0; i < MAX_ELEMS; i++) {
+    seed = seed * 1664525 + 1013904223;
+    double x = (double)(int32_t)seed / (1u << 31) * (1 << (seed % 20));
+    input_f32[i] = (float)x;
+    input_f64[i] = (double)input_f32[i];
+  }
+  for (size_t vl = 1; vl <= vlmax_e32; vl = vl * 2 + 1)
+    errors += directed_f32(vl);
+  for (size_t vl = 1; vl <= vlmax_e64; vl = vl * 2 + 1)
+    errors += directed_f64(vl);
+
+  return errors;
+}
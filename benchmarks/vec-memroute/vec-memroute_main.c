@@ -0,0 +1,98 @@
+// See LICENSE for license details.
+
+//**************************************************************************
+// Vector memory routing working-set sweep
+//--------------------------------------------------------------------------
+//
+// Repeatedly streams over working sets from a few hundred bytes up to
+// well past the L1 capacity, with unit-stride sums, unit-stride copies
+// and strided sums. Running it on configs with different l1StreamBytes
+// settings shows where the L1 port and the direct TileLink port cross
+// over for each access pattern.
+
+#include <string.h>
+#include <stdio.h>
+#include <riscv_vector.h>
+#include "util.h"
+
+#define MAX_ELEMS (64 * 1024)
+#define MIN_ELEMS (128)
+#define REPS (4)
+#define STRIDE (4)
+
+int src[MAX_ELEMS];
+int dst[MAX_ELEMS];
+
+size_t time_sum(size_t n, size_t stride, long* result) {
+  size_t vlmax = __riscv_vsetvlmax_e32m1();
+  long sum = 0;
+  size_t start = read_csr(mcycle);
+  for (size_t r = 0; r < REPS; r++) {
+    vint32m1_t acc = __riscv_vmv_v_x_i32m1(0, vlmax);
+    for (size_t i = 0; i < n; ) {
+      size_t vl = __riscv_vsetvl_e32m1((n - i) / stride);
+      if (vl == 0) break;
+      vint32m1_t v = stride == 1 ?
+        __riscv_vle32_v_i32m1(src + i, vl) :
+        __riscv_vlse32_v_i32m1(src + i, stride * sizeof(int), vl);
+      acc = __riscv_vadd_vv_i32m1_tu(acc, acc, v, vl);
+      i += vl * stride;
+    }
+    vint32m1_t red = __riscv_vredsum_vs_i32m1_i32m1(acc, __riscv_vmv_s_x_i32m1(0, 1), vlmax);
+    sum += __riscv_vmv_x_s_i32m1_i32(red);
+  }
+  *result = sum;
+  return read_csr(mcycle) - start;
+}
+
+size_t time_copy(size_t n) {
+  size_t start = read_csr(mcycle);
+  for (size_t r = 0; r < REPS; r++) {
+    for (size_t i = 0; i < n; ) {
+      size_t vl = __riscv_vsetvl_e32m8(n - i);
+      __riscv_vse32_v_i32m8(dst + i, __riscv_vle32_v_i32m8(src + i, vl), vl);
+      i += vl;
+    }
+  }
+  asm volatile("fence");
+  return read_csr(mcycle) - start;
+}
+
+long reference(size_t n, size_t stride) {
+  long sum = 0;
+  for (size_t i = 0; i + stride <= n; i += stride) sum += src[i];
+  return sum * REPS;
+}
+
+int main( int argc, char* argv[] )
+{
+  for (size_t i = 0; i < MAX_ELEMS; i++) src[i] = i % 13;
+
+  int errors = 0;
+  long sum;
+
+  printf("bytes,unit_sum,unit_copy,strided_sum\n");
+  for (size_t n = MIN_ELEMS; n <= MAX_ELEMS; n *= 2) {
+    // One untimed pass leaves the working set wherever the routing puts it
+    time_sum(n, 1, &sum);
+
+    size_t unit = time_sum(n, 1, &sum);
+    if (sum != reference(n, 1)) {
+      printf("unit sum n=%ld mismatch %ld != %ld\n", n, sum, reference(n, 1));
+      errors++;
+    }
+    size_t copy = time_copy(n);
+    if (memcmp(src, dst, n * sizeof(int)) != 0) {
+      printf("copy n=%ld mismatch\n", n);
+      errors++;
+    }
+    size_t strided = time_sum(n, STRIDE, &sum);
+    if (sum != reference(n, STRIDE)) {
+      printf("strided sum n=%ld mismatch %ld != %ld\n", n, sum, reference(n, STRIDE));
+      errors++;
+    }
+    printf("%ld,%ld,%ld,%ld\n", n * sizeof(int), unit / REPS, copy / REPS, strided / REPS);
+  }
+
+  return errors;
+}
@@ -0,0 +1,106 @@
+// See LICENSE for license details.
+
+// Measures allocate/deallocate cost of the utasks allocators. Every
+// runner hart allocates and frees sink-buffer-sized blocks concurrently,
+// then pairs of harts free each other's blocks to exercise cross-hart
+// frees.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utasks.h"
+#include "util.h"
+
+// EDIT THIS
+#define NUM_CORES (4)
+#define NUM_WORKERS (NUM_CORES-1)
+#define ITERS (64)
+#define REGION_SIZE (0x80000)
+
+static const size_t sizes[] = { sizeof(circular_buffer_pointers_t), 256, 2048 * sizeof(uint32_t) };
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+allocator_t* allocators[NUM_WORKERS];
+volatile std::atomic<size_t> phase = 0;
+volatile std::atomic<size_t> done = 0;
+size_t cycles[NUM_WORKERS];
+
+// blocks handed to the neighbouring hart to free
+void* handoff[NUM_WORKERS][ITERS * NUM_SIZES];
+volatile std::atomic<size_t> handed_off = 0;
+
+void local_loop(allocator_t* allocator) {
+  void* bufs[NUM_SIZES];
+  for (size_t i = 0; i < ITERS; i++) {
+    for (size_t s = 0; s < NUM_SIZES; s++) bufs[s] = allocator->allocate(sizes[s]);
+    for (size_t s = 0; s < NUM_SIZES; s++) allocator->deallocate(bufs[s]);
+  }
+}
+
+void cross_loop(allocator_t* allocator, size_t worker) {
+  for (size_t i = 0; i < ITERS * NUM_SIZES; i++) {
+    handoff[worker][i] = allocator->allocate(sizes[i % NUM_SIZES]);
+  }
+  handed_off++;
+  while (handed_off.load() < NUM_WORKERS) { };
+  void** theirs = handoff[(worker + 1) % NUM_WORKERS];
+  for (size_t i = 0; i < ITERS * NUM_SIZES; i++) {
+    allocator->deallocate(theirs[i]);
+  }
+}
+
+extern "C" void __main(void) {
+  size_t mhartid = read_csr(mhartid);
+  if (mhartid >= NUM_CORES) while (1);
+
+  if (mhartid > 0) { // worker
+    size_t worker = mhartid - 1;
+    size_t seen = 0;
+    while (1) {
+      size_t p;
+      while ((p = phase.load()) == seen) { };
+      seen = p;
+      size_t start = read_csr(mcycle);
+      if (p % 2 == 1) {
+        local_loop(allocators[worker]);
+      } else {
+        cross_loop(allocators[worker], worker);
+      }
+      cycles[worker] = read_csr(mcycle) - start;
+      done++;
+    }
+  } else {
+    heap_allocator_t heap;
+    slab_allocator_t slab(malloc(REGION_SIZE), REGION_SIZE);
+    const char* names[] = { "heap", "region", "slab" };
+
+    for (size_t a = 0; a < 3; a++) {
+      for (size_t cross = 0; cross < 2; cross++) {
+        // region allocators never free, so each run needs fresh ones
+        for (size_t w = 0; w < NUM_WORKERS; w++) {
+          if (a == 0) allocators[w] = &heap;
+          if (a == 1) allocators[w] = new region_allocator_t(malloc(REGION_SIZE), REGION_SIZE);
+          if (a == 2) allocators[w] = &slab;
+        }
+        done = 0;
+        handed_off = 0;
+        // odd phases are local, even are cross-hart
+        size_t next = phase.load() + 1;
+        if ((next % 2 == 0) != (cross == 1)) next++;
+        phase = next;
+        while (done.load() < NUM_WORKERS) { };
+
+        size_t total = 0;
+        for (size_t w = 0; w < NUM_WORKERS; w++) total += cycles[w];
+        PRINTF("%s %s: %ld cycles per alloc/free pair\n", names[a], cross ? "cross-hart" : "local",
+               total / (NUM_WORKERS * ITERS * NUM_SIZES));
+      }
+    }
+  }
+}
+
+int main(void) {
+  __main();
+  return 0;
+}
@@ -0,0 +1,90 @@
+// See LICENSE for license details.
+
+// Sweeps max_chunk for the vec-tasks pipeline with the default
+// circular buffers and with SPSC buffers on every edge. Small chunks
+// expose the per-chunk synchronization cost.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utasks.h"
+#include "../vec-tasks/vec-tasks.h"
+#include "util.h"
+#include "../vec-tasks/dataset1.h"
+
+// EDIT THIS
+#define NUM_CORES (4)
+#define NUM_RUNNERS (NUM_CORES-1)
+#define MIN_CHUNK (32)
+#define MAX_CHUNK (1024)
+
+mutex_t runner_lock;
+runner_t* runners[NUM_RUNNERS] = {0};
+
+uint32_t output_data[DATA_SIZE];
+
+volatile std::atomic<size_t> initialized_runners = 0;
+
+size_t run_pipeline(size_t max_chunk, bool spsc) {
+  stream_task_t<uint32_t>* stream_task = new stream_task_t<uint32_t>(max_chunk);
+  uint32_scale_task_t* scale_task = new uint32_scale_task_t(2, 2048, max_chunk, spsc);
+  uint32_add_task_t* add_task = new uint32_add_task_t(3, 2048, max_chunk, spsc);
+
+  stream_task->chain(scale_task);
+  scale_task->chain(add_task);
+  add_task->terminate(output_data);
+
+  runners[0]->add_task(stream_task);
+  runners[1]->add_task(scale_task);
+  runners[2]->add_task(add_task);
+
+  memset(output_data, 0, sizeof(output_data));
+  size_t start = read_csr(mcycle);
+  stream_task->push_work(input_data, DATA_SIZE);
+  stream_task->set_may_finish();
+  add_task->wait_for_finished();
+  size_t end = read_csr(mcycle);
+
+  for (size_t i = 0; i < DATA_SIZE; i++) {
+    if (output_data[i] != verify_data[i]) {
+      PRINTF("Mismatch max_chunk=%ld spsc=%d %ld %x != %x\n", max_chunk, spsc, i, output_data[i], verify_data[i]);
+      exit(1);
+    }
+  }
+
+  for (size_t i = 0; i < NUM_RUNNERS; i++) while (!runners[i]->idle()) { } // retire the finished tasks
+  return end - start;
+}
+
+extern "C" void __main(void) {
+  size_t mhartid = read_csr(mhartid);
+  if (mhartid >= NUM_CORES) while (1);
+
+  if (mhartid > 0) { // runner
+    size_t runner_id = mhartid - 1;
+    runner_lock.lock();
+    runners[runner_id] = new runner_t(runner_id, new heap_allocator_t);
+    initialized_runners++;
+    runner_lock.unlock();
+
+    runners[runner_id]->run(); // spins forever
+    __builtin_unreachable();
+  } else {
+    while (initialized_runners.load() < NUM_RUNNERS) { }; // wait for runners to come up
+
+    run_pipeline(MAX_CHUNK, false); // warm up
+
+    PRINTF("max_chunk,default,spsc\n");
+    for (size_t max_chunk = MIN_CHUNK; max_chunk <= MAX_CHUNK; max_chunk *= 2) {
+      size_t cycles = run_pipeline(max_chunk, false);
+      size_t spsc_cycles = run_pipeline(max_chunk, true);
+      PRINTF("%ld,%ld,%ld\n", max_chunk, cycles, spsc_cycles);
+    }
+  }
+}
+
+int main(void) {
+  __main();
+  return 0;
+}
@@ -0,0 +1,101 @@
+// See LICENSE for license details.
+
+// Runs the vec-tasks pipeline with scale and add as separate stages on
+// two runners, then with both fused into one stage on a single runner,
+// where the intermediate values never leave the vector registers.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utasks.h"
+#include "../vec-tasks/vec-tasks.h"
+#include "util.h"
+#include "../vec-tasks/dataset1.h"
+
+// EDIT THIS
+#define NUM_CORES (4)
+#define NUM_RUNNERS (NUM_CORES-1)
+
+mutex_t runner_lock;
+runner_t* runners[NUM_RUNNERS] = {0};
+
+uint32_t output_data[DATA_SIZE];
+
+volatile std::atomic<size_t> initialized_runners = 0;
+
+void verify(const char* name) {
+  for (size_t i = 0; i < DATA_SIZE; i++) {
+    if (output_data[i] != verify_data[i]) {
+      PRINTF("%s Mismatch %ld %p %x != %x\n", name, i, &output_data[i], output_data[i], verify_data[i]);
+      exit(1);
+    }
+  }
+}
+
+size_t measure(stream_task_t<uint32_t>* stream_task, task_t* last_task) {
+  memset(output_data, 0, sizeof(output_data));
+  size_t start = read_csr(mcycle);
+  stream_task->push_work(input_data, DATA_SIZE);
+  stream_task->set_may_finish();
+  last_task->wait_for_finished();
+  size_t end = read_csr(mcycle);
+  for (size_t i = 0; i < NUM_RUNNERS; i++) while (!runners[i]->idle()) { } // retire the finished tasks
+  return end - start;
+}
+
+size_t run_separate() {
+  stream_task_t<uint32_t>* stream_task = new stream_task_t<uint32_t>(512);
+  uint32_scale_task_t* scale_task = new uint32_scale_task_t(2, 2048, 512);
+  uint32_add_task_t* add_task = new uint32_add_task_t(3, 2048, 512);
+  stream_task->chain(scale_task);
+  scale_task->chain(add_task);
+  add_task->terminate(output_data);
+  runners[0]->add_task(stream_task);
+  runners[1]->add_task(scale_task);
+  runners[2]->add_task(add_task);
+  size_t cycles = measure(stream_task, add_task);
+  verify("separate");
+  return cycles;
+}
+
+size_t run_fused() {
+  stream_task_t<uint32_t>* stream_task = new stream_task_t<uint32_t>(512);
+  uint32_scale_add_task_t* fused_task = new uint32_scale_add_task_t(
+    { uint32_scale_kernel_t(2), uint32_add_kernel_t(3) }, 2048, 512);
+  stream_task->chain(fused_task);
+  fused_task->terminate(output_data);
+  runners[0]->add_task(stream_task);
+  runners[1]->add_task(fused_task);
+  size_t cycles = measure(stream_task, fused_task);
+  verify("fused");
+  return cycles;
+}
+
+extern "C" void __main(void) {
+  size_t mhartid = read_csr(mhartid);
+  if (mhartid >= NUM_CORES) while (1);
+
+  if (mhartid > 0) { // runner
+    size_t runner_id = mhartid - 1;
+    runner_lock.lock();
+    runners[runner_id] = new runner_t(runner_id, new heap_allocator_t);
+    initialized_runners++;
+    runner_lock.unlock();
+
+    runners[runner_id]->run(); // spins forever
+    __builtin_unreachable();
+  } else {
+    while (initialized_runners.load() < NUM_RUNNERS) { }; // wait for runners to come up
+
+    run_separate(); // warm up
+    run_fused();
+    PRINTF("separate stages took %ld cycles\n", run_separate());
+    PRINTF("fused stage took %ld cycles\n", run_fused());
+  }
+}
+
+int main(void) {
+  __main();
+  return 0;
+}
@@ -0,0 +1,116 @@
+// See LICENSE for license details.
+
+// vec-tasks with an imbalanced task placement. Runner 0 is given three
+// stages, runner 1 two, and runner 2 none. With WORK_STEALING the idle
+// runners steal ready stages; without it every stage stays pinned.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "utasks.h"
+#include "../vec-tasks/vec-tasks.h"
+#include "util.h"
+#include "../vec-tasks/dataset1.h"
+
+// EDIT THIS
+#define NUM_CORES (4)
+#define NUM_RUNNERS (NUM_CORES-1)
+#define WORK_STEALING (1) // 0 for the statically pinned baseline
+
+mutex_t runner_lock;
+runner_t* runners[NUM_RUNNERS] = {0};
+#if WORK_STEALING
+ws_pool_t pool;
+#endif
+
+uint32_t output_data[DATA_SIZE];
+
+volatile std::atomic<size_t> initialized_runners = 0;
+
+extern "C" void __main(void) {
+  size_t mhartid = read_csr(mhartid);
+  if (mhartid >= NUM_CORES) while (1);
+
+  if (mhartid > 0) { // runner
+    size_t runner_id = mhartid - 1;
+    runner_lock.lock();
+    size_t base = 0x70000000 + 0x10000 * mhartid;
+#if WORK_STEALING
+    runners[runner_id] = new runner_t(runner_id, new region_allocator_t((void*)base, 0x10000), &pool);
+#else
+    runners[runner_id] = new runner_t(runner_id, new region_allocator_t((void*)base, 0x10000));
+#endif
+    PRINTF("Initialized runner %ld\n", runner_id);
+    initialized_runners++;
+    runner_lock.unlock();
+
+    runners[runner_id]->run(); // spins forever
+    __builtin_unreachable();
+  } else { // create and distribute tasks
+
+    while (initialized_runners.load() < NUM_RUNNERS) { }; // wait for runners to come up
+
+    // out = ((in * 2) + 3) * 1 + 0, so dataset1's verify_data still holds
+    stream_task_t<uint32_t>* stream_task = new stream_task_t<uint32_t>(512);
+    uint32_scale_task_t* scale_task = new uint32_scale_task_t(2, 2048, 512);
+    uint32_add_task_t* add_task = new uint32_add_task_t(3, 2048, 512);
+    uint32_scale_task_t* scale1_task = new uint32_scale_task_t(1, 2048, 512);
+    uint32_add_task_t* add0_task = new uint32_add_task_t(0, 2048, 512);
+
+    stream_task->chain(scale_task);
+    scale_task->chain(add_task);
+    add_task->chain(scale1_task);
+    scale1_task->chain(add0_task);
+    add0_task->terminate(output_data);
+
+    // imbalanced placement, runner 2 gets nothing
+    runners[0]->add_task(stream_task);
+    runners[0]->add_task(scale_task);
+    runners[0]->add_task(add_task);
+    runners[1]->add_task(scale1_task);
+    runners[1]->add_task(add0_task);
+
+    // warm up the system, push the first set of tasks through
+    stream_task->push_work(input_data, DATA_SIZE);
+    while (add0_task->has_work() || scale1_task->has_work() || add_task->has_work() ||
+           scale_task->has_work() || stream_task->has_work()) { };
+
+    for (size_t i = 0; i < DATA_SIZE; i++) {
+      uint32_t ref = verify_data[i];
+      uint32_t out = output_data[i];
+      if (out != ref) {
+	PRINTF("early Mismatch %p %x != %x\n", &output_data[i], out, ref);
+	exit(1);
+      }
+    }
+
+    add0_task->terminate(output_data);
+
+    // measure the system, push the data through again
+    PRINTF("Warmed up, starting measurement\n");
+    size_t start = read_csr(mcycle);
+    stream_task->push_work(input_data, DATA_SIZE);
+    stream_task->set_may_finish();
+    add0_task->wait_for_finished();
+    size_t end = read_csr(mcycle);
+
+    PRINTF("%s task took %ld cycles\n", WORK_STEALING ? "work-stealing" : "pinned", end - start);
+
+    for (size_t i = 0; i < DATA_SIZE; i++) {
+      uint32_t ref = verify_data[i];
+      uint32_t out = output_data[i];
+      if (out != ref) {
+	PRINTF("Mismatch %ld %p %x != %x\n", i, &output_data[i], out, ref);
+	exit(1);
+      }
+    }
+
+    for (size_t i = 0; i < NUM_RUNNERS; i++) while (!runners[i]->idle()) { } // Wait for idle
+  }
+}
+
+int main(void) {
+  __main();
+  return 0;
+}
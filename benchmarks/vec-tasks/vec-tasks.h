@@ -11,7 +11,7 @@ class stream_task_t : public source_task_t<T> {
 public:
   stream_task_t(size_t max_chunk) : source_task_t<T>(max_chunk) { }
   bool has_work() { return work_queue.size() > 0; }
-  void push_work(T* base, size_t n) { work_queue.push_back(std::pair(base, n)); }
+  void push_work(T* base, size_t n) { work_queue.push_back(std::pair(base, n)); this->notify(); }
   size_t kernel(T* out, size_t n) {
     if (work_queue.size() == 0) {
       return 0;
@@ -71,7 +71,7 @@ private:
 
 class uint32_scale_task_t : public pipe_task_t<uint32_t, uint32_t> {
 public:
-  uint32_scale_task_t(uint32_t scale, size_t buffer_size, size_t max_chunk) : scale(scale), pipe_task_t<uint32_t, uint32_t>(buffer_size, max_chunk) { }
+  uint32_scale_task_t(uint32_t scale, size_t buffer_size, size_t max_chunk, bool spsc = false) : scale(scale), pipe_task_t<uint32_t, uint32_t>(buffer_size, max_chunk, spsc) { }
   size_t kernel(uint32_t* in, uint32_t* out, size_t n) {
     size_t avl = n;
     size_t consumed1 = __riscv_vsetvl_e32m8(avl);
@@ -114,7 +114,7 @@ private:
 
 class uint32_add_task_t : public pipe_task_t<uint32_t, uint32_t> {
 public:
-  uint32_add_task_t(uint32_t add, size_t buffer_size, size_t max_chunk) : add(add), pipe_task_t<uint32_t, uint32_t>(buffer_size, max_chunk) { }
+  uint32_add_task_t(uint32_t add, size_t buffer_size, size_t max_chunk, bool spsc = false) : add(add), pipe_task_t<uint32_t, uint32_t>(buffer_size, max_chunk, spsc) { }
   size_t kernel(uint32_t* in, uint32_t* out, size_t n) {
     size_t avl = n;
     size_t consumed1 = __riscv_vsetvl_e32m8(avl);
@@ -152,5 +152,28 @@ private:
   uint32_t add;
 };
 
+// Kernels for fused_pipe_task_t, over LMUL=8 strips of uint32_t
+struct uint32_m8_strip_t {
+  typedef uint32_t elem_t;
+  typedef vuint32m8_t vec_t;
+  static size_t setvl(size_t n) { return __riscv_vsetvl_e32m8(n); }
+  static vec_t load(const uint32_t* in, size_t vl) { return __riscv_vle32_v_u32m8(in, vl); }
+  static void store(uint32_t* out, vec_t v, size_t vl) { __riscv_vse32_v_u32m8(out, v, vl); }
+};
+
+struct uint32_scale_kernel_t {
+  uint32_scale_kernel_t(uint32_t scale) : scale(scale) { }
+  vuint32m8_t operator()(vuint32m8_t v, size_t vl) const { return __riscv_vmul_vx_u32m8(v, scale, vl); }
+  uint32_t scale;
+};
+
+struct uint32_add_kernel_t {
+  uint32_add_kernel_t(uint32_t add) : add(add) { }
+  vuint32m8_t operator()(vuint32m8_t v, size_t vl) const { return __riscv_vadd_vx_u32m8(v, add, vl); }
+  uint32_t add;
+};
+
+// scale then add in one stage
+typedef fused_pipe_task_t<uint32_m8_strip_t, uint32_scale_kernel_t, uint32_add_kernel_t> uint32_scale_add_task_t;
 
 #endif
@@ -12,6 +12,16 @@
 // EDIT THIS
 #define NUM_CORES (4)
 #define NUM_RUNNERS (NUM_CORES-1)
+#define BACKOFF (1) // 0 for hot-spinning runners
+
+// Idle runners pause for 1 to 64 hints per empty poll and sleep after 256
+// empty polls. Compare the measured cycles against a BACKOFF 0 build to
+// see how much throughput the busy harts recover
+#if BACKOFF
+const backoff_t backoff(1, 64, 256);
+#else
+const backoff_t backoff;
+#endif
 
 mutex_t runner_lock;
 runner_t* runners[NUM_RUNNERS] = {0};
@@ -33,6 +43,7 @@ extern "C" void __main(void) {
       size_t base = 0x70000000 + 0x10000 * mhartid;
       runners[runner_id] = new runner_t(runner_id, new region_allocator_t((void*)base, 0x10000));
     }
+    runners[runner_id]->set_backoff(backoff);
     PRINTF("Initialized runner %ld\n", runner_id);
     initialized_runners++;
     runner_lock.unlock();
@@ -78,10 +89,10 @@ extern "C" void __main(void) {
     size_t start = read_csr(mcycle);
     stream_task->push_work(input_data, DATA_SIZE);
     stream_task->set_may_finish();
-    add_task->wait_for_finished();
+    add_task->wait_for_finished(backoff);
     size_t end = read_csr(mcycle);
 
-    PRINTF("task took %ld cycles\n", end - start);
+    PRINTF("%s task took %ld cycles\n", BACKOFF ? "backoff" : "spin", end - start);
 
     for (size_t i = 0; i < DATA_SIZE; i++) {
       uint32_t ref = verify_data[i];
@@ -8,6 +8,7 @@ rm -rf out/
 
 make MODE=machine VLEN=256 XLEN=64 SPLIT=50000 TEST_MODE="cosim" generate-stage1
 make MODE=machine VLEN=256 XLEN=64 SPLIT=50000 TEST_MODE="cosim" all -j72
+# Spike sums these in order; benchmarks/vec-fredsum checks unordered sums
 rm -rf out/v256x64machine/bin/stage2/vfredusum*
 rm -rf out/v256x64machine/bin/stage2/vfwredusum*
 rm -rf out/v256x64machine/bin/stage2/vaes*
@@ -23,6 +24,7 @@ make MODE=virtual VLEN=256 XLEN=64 SPLIT=6000 TEST_MODE="cosim" PATTERN='^v[ls].
 
 make MODE=machine VLEN=128 XLEN=64 SPLIT=50000 TEST_MODE="cosim" generate-stage1
 make MODE=machine VLEN=128 XLEN=64 SPLIT=50000 TEST_MODE="cosim" all -j72
+# Spike sums these in order; benchmarks/vec-fredsum checks unordered sums
 rm -rf out/v128x64machine/bin/stage2/vfredusum*
 rm -rf out/v128x64machine/bin/stage2/vfwredusum*
 rm -rf out/v128x64machine/bin/stage2/vaes*
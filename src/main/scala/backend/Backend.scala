@@ -34,6 +34,8 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
     val vat_head = Input(UInt(vParams.vatSz.W))
 
     val vat_release = Output(Vec(nRelease, Valid(UInt(vParams.vatSz.W))))
+
+    val vrf_home = Input(UInt((if (vParams.vrfRenaming) 32 else 0).W))
   })
 
   require(vLen >= 64)
@@ -46,7 +48,8 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   // ====================================================================
   // Set up the dispatch queue, issue queues, sequencers, execution units
 
-  val vdq = Module(new DCEQueue(new VectorIssueInst, vParams.vdqEntries))
+  val vdq = Module(new DCEQueue(new VectorIssueInst, vParams.vdqEntries,
+    dualDeq = vParams.dualDispatch && vParams.enableOOO))
   vdq.io.enq <> io.dis
 
 
@@ -54,12 +57,12 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   val vlissq = Module(new IssueQueue(vParams.vlissqEntries, 1))
   val vsissq = Module(new IssueQueue(vParams.vsissqEntries, 1))
   val vpissq = Module(new IssueQueue(vParams.vpissqEntries, 2)) // permute/reduction
-  val vxissqs = xissParams.map(q => Module(new IssueQueue(q.depth, q.seqs.size + 1)).suggestName(s"vxissq_${q.name}")) // +1 hack for opu
+  val vxissqs = xissParams.map(q => Module(new IssueQueue(q.depth, q.seqs.size + 2)).suggestName(s"vxissq_${q.name}")) // +2 hack for opu
 
   val vxus = xissParams.map(_.seqs.map(s => Module(new ExecutionUnit(s.fus, s.name)).suggestName(s"vxu${s.name}")))
   val flat_vxus = vxus.flatten
   val vopu = Option.when(useOpu) { Module(new OuterProductUnit) }
-  val maxPipeDepth = (flat_vxus.map(_.maxPipeDepth) ++ vopu.map(_.yDim + 2)).max
+  val maxPipeDepth = (flat_vxus.map(_.maxPipeDepth) ++ vopu.map(_.mvoutLatency)).max
 
 
   val vls = Module(new LoadSequencer)
@@ -68,12 +71,18 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
     Module(new ExecuteSequencer(s.insns, maxPipeDepth, s.fus.size)).suggestName(s"vxs${s.name}")
   ))
 
-  val vos = Option.when(useOpu) { Module(new OuterProductSequencer) }
-  val all_supported_insns = xissParams.map(_.insns).flatten ++ vos.map(_.opu_insns).getOrElse(Nil)
+  val vos_macc = Option.when(useOpu) { Module(new OuterProductSequencer(true)).suggestName("vos_macc") }
+  val vos_move = Option.when(useOpu) { Module(new OuterProductSequencer(false)).suggestName("vos_move") }
+  val vos = vos_macc.toSeq ++ vos_move
+  val all_supported_insns = xissParams.map(_.insns).flatten ++ vos.map(_.opu_insns).flatten
   val vps = Module(new SpecialSequencer(all_supported_insns))
 
   val allSeqs = Seq(vls, vss, vps) ++ vxs.flatten ++ vos
   val allIssQs = Seq(vlissq, vsissq, vpissq) ++ vxissqs
+  val allSeqNames = Seq("vls", "vss", "vps") ++ xissParams.map(_.seqs.map(s => s"vxs${s.name}")).flatten ++
+    (if (useOpu) Seq("vos_macc", "vos_move") else Nil)
+
+  val perf = IO(Output(new VectorBackendPerf(allSeqs.size)))
 
   val flat_vxs = vxs.flatten
   require(flat_vxs.size == flat_vxus.size)
@@ -108,75 +117,150 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   // ======================================
   // Set inputs to each issq/sequencer pair
 
-  // Set common defaults
-  for (issq <- allIssQs) {
-    issq.io.enq.bits.reduction := false.B
-    issq.io.enq.bits.wide_vd := false.B
-    issq.io.enq.bits.wide_vs2 := false.B
-    issq.io.enq.bits.writes_mask := false.B
-    issq.io.enq.bits.reads_vs1_mask := false.B
-    issq.io.enq.bits.reads_vs2_mask := false.B
-    issq.io.enq.bits.nf_log2 := 0.U
-    issq.io.enq.bits.renv1 := false.B
-    issq.io.enq.bits.renv2 := false.B
-    issq.io.enq.bits.renvd := false.B
-    issq.io.enq.bits.renvm := false.B
-    issq.io.enq.bits.wvd   := false.B
-    issq.io.enq.bits.scalar_to_vd0 := false.B
-    issq.io.enq.bits.rs1_is_rs2 := false.B
+  // Build the issue queue entry each group would receive for inst
+  def issqEntries(inst: VectorIssueInst): Seq[IssueQueueInst] = {
+    val entries = issGroups.map { group =>
+      val e = Wire(chiselTypeOf(group.issq.io.enq.bits))
+      e.viewAsSupertype(new VectorIssueInst) := inst
+      e.seq := VecInit(group.seqs.map(_.accepts(inst))).asUInt
+
+      // Set common defaults
+      e.reduction := false.B
+      e.wide_vd := false.B
+      e.wide_vs2 := false.B
+      e.writes_mask := false.B
+      e.reads_vs1_mask := false.B
+      e.reads_vs2_mask := false.B
+      e.nf_log2 := 0.U
+      e.renv1 := false.B
+      e.renv2 := false.B
+      e.renvd := false.B
+      e.renvm := false.B
+      e.wvd   := false.B
+      e.scalar_to_vd0 := false.B
+      e.rs1_is_rs2 := false.B
+      e
+    }
+    val Seq(vl, vs, vp) = entries.take(3)
+    val vx = entries.drop(3)
+
+    val dis_ctrl = Wire(new VectorDecodedControl(all_supported_insns, Seq(
+      Reduction, Wide2VD, Wide2VS2, WritesAsMask,
+      ReadsVS1AsMask, ReadsVS2AsMask, ReadsVS1, ReadsVS2, ReadsVD,
+      VMBitReadsVM, AlwaysReadsVM, WritesVD, WritesScalar, ScalarToVD0
+    ))).decode(inst)
+
+    // Load sequencer
+    vl.nf_log2 := log2_up(inst.nf, 8)
+    vl.renvm := !inst.vm
+    vl.wvd   := true.B
+
+    // Store sequencer
+    vs.nf_log2 := log2_up(inst.nf, 8)
+    vs.renvd := true.B
+    vs.renvm := !inst.vm && inst.mop === mopUnit
+
+    // Permute source sequencer
+    vp.renv1 := !inst.vmu && dis_ctrl.bool(Reduction)
+    vp.renv2 := (inst.mop(0) || (!inst.vmu && !dis_ctrl.bool(Reduction)))
+    vp.renvd := !dis_ctrl.bool(Reduction)
+    vp.renvm := !inst.vm && inst.mop =/= mopUnit && inst.vmu
+    vp.wide_vd := dis_ctrl.bool(Wide2VD) && !inst.vmu
+    vp.rs1_is_rs2 := !inst.vmu && (inst.opif6 === OPIFunct6.rgather || (inst.funct3 === OPIVV && inst.opif6 === OPIFunct6.rgatherei16))
+
+    // Execute sequencers
+    vx.foreach { e =>
+      e.wide_vd := dis_ctrl.bool(Wide2VD)
+      e.wide_vs2 := dis_ctrl.bool(Wide2VS2)
+      e.writes_mask := dis_ctrl.bool(WritesAsMask)
+      e.reads_vs1_mask := dis_ctrl.bool(ReadsVS1AsMask)
+      e.reads_vs2_mask := dis_ctrl.bool(ReadsVS2AsMask)
+      e.renv1 := dis_ctrl.bool(ReadsVS1) && !dis_ctrl.bool(Reduction)
+      e.renv2 := dis_ctrl.bool(ReadsVS2)
+      e.renvd := dis_ctrl.bool(ReadsVD)
+      e.renvm := (!inst.vm && dis_ctrl.bool(VMBitReadsVM)) || dis_ctrl.bool(AlwaysReadsVM)
+      e.wvd := !dis_ctrl.bool(WritesScalar)
+      e.scalar_to_vd0 := dis_ctrl.bool(ScalarToVD0)
+      e.reduction := dis_ctrl.bool(Reduction)
+    }
+    entries
   }
 
-  val dis_ctrl = Wire(new VectorDecodedControl(all_supported_insns, Seq(
-    Reduction, Wide2VD, Wide2VS2, WritesAsMask,
-    ReadsVS1AsMask, ReadsVS2AsMask, ReadsVS1, ReadsVS2, ReadsVD,
-    VMBitReadsVM, AlwaysReadsVM, WritesVD, WritesScalar, ScalarToVD0
-  ))).decode(vdq.io.deq.bits)
-
-  // Load sequencer
-  vlissq.io.enq.bits.nf_log2 := log2_up(vdq.io.deq.bits.nf, 8)
-  vlissq.io.enq.bits.renvm := !vdq.io.deq.bits.vm
-  vlissq.io.enq.bits.wvd   := true.B
-
-  // Store sequencer
-  vsissq.io.enq.bits.nf_log2 := log2_up(vdq.io.deq.bits.nf, 8)
-  vsissq.io.enq.bits.renvd := true.B
-  vsissq.io.enq.bits.renvm := !vdq.io.deq.bits.vm && vdq.io.deq.bits.mop === mopUnit
-
-  // Permute source sequencer
-  vpissq.io.enq.bits.renv1 := !vdq.io.deq.bits.vmu && dis_ctrl.bool(Reduction)
-  vpissq.io.enq.bits.renv2 := (vdq.io.deq.bits.mop(0) || (!vdq.io.deq.bits.vmu && !dis_ctrl.bool(Reduction)))
-  vpissq.io.enq.bits.renvd := !dis_ctrl.bool(Reduction)
-  vpissq.io.enq.bits.renvm := !vdq.io.deq.bits.vm && vdq.io.deq.bits.mop =/= mopUnit && vdq.io.deq.bits.vmu
-  vpissq.io.enq.bits.wide_vd := dis_ctrl.bool(Wide2VD) && !vdq.io.deq.bits.vmu
-  vpissq.io.enq.bits.rs1_is_rs2 := !vdq.io.deq.bits.vmu && (vdq.io.deq.bits.opif6 === OPIFunct6.rgather || (vdq.io.deq.bits.funct3 === OPIVV && vdq.io.deq.bits.opif6 === OPIFunct6.rgatherei16))
-
-  // Execute sequencers
-  vxissqs.foreach { vxissq =>
-    vxissq.io.enq.bits.wide_vd := dis_ctrl.bool(Wide2VD)
-    vxissq.io.enq.bits.wide_vs2 := dis_ctrl.bool(Wide2VS2)
-    vxissq.io.enq.bits.writes_mask := dis_ctrl.bool(WritesAsMask)
-    vxissq.io.enq.bits.reads_vs1_mask := dis_ctrl.bool(ReadsVS1AsMask)
-    vxissq.io.enq.bits.reads_vs2_mask := dis_ctrl.bool(ReadsVS2AsMask)
-    vxissq.io.enq.bits.renv1 := dis_ctrl.bool(ReadsVS1) && !dis_ctrl.bool(Reduction)
-    vxissq.io.enq.bits.renv2 := dis_ctrl.bool(ReadsVS2)
-    vxissq.io.enq.bits.renvd := dis_ctrl.bool(ReadsVD)
-    vxissq.io.enq.bits.renvm := (!vdq.io.deq.bits.vm && dis_ctrl.bool(VMBitReadsVM)) || dis_ctrl.bool(AlwaysReadsVM)
-    vxissq.io.enq.bits.wvd := !dis_ctrl.bool(WritesScalar)
-    vxissq.io.enq.bits.scalar_to_vd0 := dis_ctrl.bool(ScalarToVD0)
-    vxissq.io.enq.bits.reduction := dis_ctrl.bool(Reduction)
+
+  // ======================================
+  // Dispatch from the VDQ to issue queues
+  //
+  // With dualDispatch, two instructions can dispatch per cycle to disjoint
+  // sets of issue queues. A head instruction whose issue queue is full
+  // is moved aside into dis_hold. It remains the oldest dispatch
+  // candidate, but younger instructions bound for other issue queues may
+  // pass it if they do not access any vreg it accesses.
+
+  val dualDispatch = vParams.dualDispatch && vParams.enableOOO
+  val dis_hold_valid = RegInit(false.B)
+  val dis_hold = Reg(new VectorIssueInst)
+
+  val dis_slots = Wire(Vec(if (dualDispatch) 2 else 1, Valid(new VectorIssueInst)))
+  if (dualDispatch) {
+    val vdq_second = vdq.io.deq_second.get
+    dis_slots(0).valid := dis_hold_valid || vdq.io.deq.valid
+    dis_slots(0).bits  := Mux(dis_hold_valid, dis_hold, vdq.io.deq.bits)
+    dis_slots(1).valid := Mux(dis_hold_valid, vdq.io.deq.valid, vdq_second.valid)
+    dis_slots(1).bits  := Mux(dis_hold_valid, vdq.io.deq.bits, vdq_second.bits)
+  } else {
+    dis_slots(0).valid := vdq.io.deq.valid
+    dis_slots(0).bits  := vdq.io.deq.bits
   }
 
+  val dis_entries = dis_slots.map(s => issqEntries(s.bits))
+  val dis_targets = dis_slots.zip(dis_entries).map { case (s, es) =>
+    VecInit(es.map(e => s.valid && e.seq.orR)).asUInt
+  }
+  val issq_ready = VecInit(issGroups.map(_.issq.io.enq.ready)).asUInt
+  val dis_fire = Wire(Vec(dis_slots.size, Bool()))
+  dis_fire(0) := dis_slots(0).valid && (dis_targets(0) & ~issq_ready) === 0.U
+
+  if (dualDispatch) {
+    // The younger slot may dispatch past the older slot only if neither
+    // accesses a vreg the other writes
+    def vregIntents(t: UInt, es: Seq[IssueQueueInst]) = (
+      es.zipWithIndex.map { case (e, i) => Mux(t(i), e.rintent, 0.U) }.reduce(_|_),
+      es.zipWithIndex.map { case (e, i) => Mux(t(i), e.wintent, 0.U) }.reduce(_|_)
+    )
+    val (older_r, older_w) = vregIntents(dis_targets(0), dis_entries(0))
+    val (younger_r, younger_w) = vregIntents(dis_targets(1), dis_entries(1))
+    val independent = (older_w & (younger_r | younger_w)) === 0.U && (older_r & younger_w) === 0.U
+
+    dis_fire(1) := (dis_slots(1).valid && (dis_targets(1) & ~issq_ready) === 0.U &&
+      (dis_targets(0) & dis_targets(1)) === 0.U &&
+      (dis_fire(0) || independent))
+
+    // Without a held instruction the head always leaves the VDQ, either
+    // into an issue queue or into dis_hold
+    vdq.io.deq.ready := !dis_hold_valid || dis_fire(0) || dis_fire(1)
+    vdq.io.deq_second.get.ready := !dis_hold_valid && dis_fire(1)
+    when (dis_hold_valid) {
+      when (dis_fire(0)) {
+        dis_hold_valid := vdq.io.deq.valid && !dis_fire(1)
+        dis_hold := vdq.io.deq.bits
+      }
+    } .otherwise {
+      when (vdq.io.deq.valid && !dis_fire(0)) {
+        dis_hold_valid := true.B
+        dis_hold := vdq.io.deq.bits
+      }
+    }
+  } else {
+    vdq.io.deq.ready := dis_fire(0)
+  }
 
   // ======================================
-  // Connect VDQ to issue queues
   // Connect issue queues to sequencers
 
-  val issq_stall = Wire(Vec(issGroups.size, Bool()))
-  vdq.io.deq.ready := !issq_stall.orR
-
   var flat_vxu_id: Int = 0
 
-  val vos_wsboard = vos.map(_.io.wsboard).getOrElse(0.U)
+  val vos_wsboard = vos_move.map(_.io.wsboard).getOrElse(0.U)
+  def vosWrites(eg: UInt) = vos_move.map(_.io.wsboard(eg)).getOrElse(false.B)
   for ((group, i) <- issGroups.zipWithIndex) {
     val otherIssGroups = issGroups.zipWithIndex.filter(_._2 != i).map(_._1)
     val otherIssqs = otherIssGroups.map(_.issq)
@@ -190,21 +274,16 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
 
       seq.io.vat_head := io.vat_head
 
-      val older_issq_wintents = FillInterleaved(egsPerVReg, otherIssqs.map { i =>
+      // Issue queue intents are per vreg
+      val older_issq_wvregs = otherIssqs.map { i =>
         i.io.hazards.map(h => Mux(vatOlder(h.bits.vat, vat) && h.valid, h.bits.wintent, 0.U))
-      }.flatten.foldLeft(0.U)(_|_))
-      val older_seq_wintents = otherSeqs.map { s =>
-        Mux(vatOlder(s.io.seq_hazard.bits.vat, vat) && s.io.seq_hazard.valid, s.io.seq_hazard.bits.wintent, 0.U)
-      }.reduce(_|_)
-      val older_wintents = older_issq_wintents | older_seq_wintents | vos_wsboard
-
-      val older_issq_rintents = FillInterleaved(egsPerVReg, otherIssqs.map { i =>
+      }.flatten.foldLeft(0.U(nPhysVRegs.W))(_|_)
+      val older_issq_rvregs = otherIssqs.map { i =>
         i.io.hazards.map(h => Mux(vatOlder(h.bits.vat, vat) && h.valid, h.bits.rintent, 0.U))
-      }.flatten.foldLeft(0.U)(_|_))
-      val older_seq_rintents = otherSeqs.map { s =>
-        Mux(vatOlder(s.io.seq_hazard.bits.vat, vat) && s.io.seq_hazard.valid, s.io.seq_hazard.bits.rintent, 0.U)
-      }.reduce(_|_)
-      val older_rintents = older_issq_rintents | older_seq_rintents
+      }.flatten.foldLeft(0.U(nPhysVRegs.W))(_|_)
+      val older_seqs = otherSeqs.map { s =>
+        (vatOlder(s.io.seq_hazard.bits.vat, vat) && s.io.seq_hazard.valid, s.io.seq_hazard.bits)
+      }
 
       val (other_vxus, same_vxu): (Seq[ExecutionUnit], Option[ExecutionUnit]) = seq match {
         case s: ExecuteSequencer => {
@@ -219,20 +298,41 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
       // Older writes from adjacent VXUs will always induce WAW/RAW, but older
       // writes from the same VXU may be from the same instruction, and no WAR
       // or RAW is possible
-      val older_other_pipe_writes = other_vxus.map(_.io.pipe_hazards.toSeq).flatten.map { h =>
-        Mux(h.valid, h.bits.eg_oh, 0.U)
-      }.foldLeft(0.U)(_|_)
-      val older_same_pipe_writes = same_vxu.map(_.io.pipe_hazards.toSeq.map { h =>
-        Mux(h.valid && h.bits.vat =/= vat, h.bits.eg_oh, 0.U)
-      }.reduce(_|_)).getOrElse(0.U)
-      val older_pipe_writes = older_other_pipe_writes | older_same_pipe_writes
-
-      val older_iter_writes = flat_vxus.map(_.io.iter_hazards.toSeq).flatten.map { h =>
-        Mux(h.valid, h.bits.eg_oh, 0.U)
-      }.reduce(_|_)
+      val older_pipe_hazards = other_vxus.map(_.io.pipe_hazards.toSeq).flatten.map { h =>
+        (h.valid, h.bits.eg)
+      } ++ same_vxu.toSeq.map(_.io.pipe_hazards.toSeq).flatten.map { h =>
+        (h.valid && h.bits.vat =/= vat, h.bits.eg)
+      } ++ flat_vxus.map(_.io.iter_hazards.toSeq).flatten.map { h =>
+        (h.valid, h.bits.eg)
+      }
 
-      seq.io.older_writes := older_pipe_writes | older_iter_writes | older_wintents
-      seq.io.older_reads := older_rintents
+      val (older_write, older_read): (UInt => Bool, UInt => Bool) = if (!vParams.intervalHazards) {
+        val older_wintents = (FillInterleaved(egsPerVReg, older_issq_wvregs) |
+          older_seqs.map { case (v, h) => Mux(v, h.wintent.mask.get, 0.U) }.reduce(_|_) |
+          vos_wsboard)
+        val older_rintents = (FillInterleaved(egsPerVReg, older_issq_rvregs) |
+          older_seqs.map { case (v, h) => Mux(v, h.rintent.mask.get, 0.U) }.reduce(_|_))
+        val older_pipe_writes = older_pipe_hazards.map { case (v, eg) => Mux(v, UIntToOH(eg), 0.U) }.foldLeft(0.U)(_|_)
+        val older_writes = older_pipe_writes | older_wintents
+        ((eg: UInt) => older_writes(eg), (eg: UInt) => older_rintents(eg))
+      } else {
+        // Compare each queried eg against the older ranges, rather than
+        // building egsTotal-wide masks
+        def vreg(eg: UInt) = (eg >> log2Ceil(egsPerVReg))(4,0)
+        ({ (eg: UInt) =>
+          older_issq_wvregs(vreg(eg)) ||
+          older_seqs.map { case (v, h) => v && h.wintent.contains(eg) }.orR ||
+          older_pipe_hazards.map { case (v, h_eg) => v && h_eg === eg }.orR ||
+          vosWrites(eg)
+        }, { (eg: UInt) =>
+          older_issq_rvregs(vreg(eg)) ||
+          older_seqs.map { case (v, h) => v && h.rintent.contains(eg) }.orR
+        })
+      }
+      val query = seq.io.hazard_query
+      seq.io.hazards.raw := query.reads.map(r => r.valid && older_write(r.bits)).orR
+      seq.io.hazards.waw := query.write.valid && older_write(query.write.bits)
+      seq.io.hazards.war := query.write.valid && older_read(query.write.bits)
 
       if (!vParams.enableOOO) {
         // stall dispatch if any other sequencers are at the head and stalled
@@ -244,12 +344,12 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
       }
     }
 
-    val accepts = group.seqs.map(_.accepts(vdq.io.deq.bits))
-    issq_stall(i) := !group.issq.io.enq.ready && accepts.orR
-
-    group.issq.io.enq.valid := vdq.io.deq.valid && !issq_stall.orR && accepts.orR
-    group.issq.io.enq.bits.viewAsSupertype(new VectorIssueInst) := vdq.io.deq.bits
-    group.issq.io.enq.bits.seq := VecInit(accepts).asUInt
+    // Issue groups targeted by both slots never dispatch together
+    group.issq.io.enq.valid := dis_fire.zip(dis_targets).map { case (f, t) => f && t(i) }.orR
+    group.issq.io.enq.bits := dis_entries.head(i)
+    if (dualDispatch) {
+      when (dis_targets(1)(i)) { group.issq.io.enq.bits := dis_entries(1)(i) }
+    }
 
     // In case of multiple available sequencers, select the first ready one
     val valid_seqs = group.issq.io.deq.bits.seq
@@ -322,6 +422,40 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
 
     vxu.io.iss.valid := vxs.io.iss.valid
     vxs.io.iss.ready := vxu.io.iss.ready
+
+    // SRAM VRF banks return the operands the cycle after issue, into the
+    // EU's first stage. Only the fields read from the VRF above are replaced.
+    vxu.io.iss_late := 0.U.asTypeOf(new ExecuteLateOperands)
+    if (vParams.vrfSRAM) {
+      val fire = vxu.io.iss.fire
+      val late = RegNext(fire, false.B)
+      val eidx = RegEnable(vxs_iss.eidx, fire)
+      val rvs1_eew = RegEnable(vxs_iss.rvs1_eew, fire)
+      val rvs2_eew = RegEnable(vxs_iss.rvs2_eew, fire)
+      val rvd_eew = RegEnable(vxs_iss.rvd_eew, fire)
+      val vrf_rvs1 = RegEnable(vxs_iss.use_normal_rvs1 && !(vxs_iss.acc && (vxs_iss.acc_fold || vxs_iss.acc_ew)), fire)
+      val vrf_rvs2 = RegEnable(vxs_iss.use_normal_rvs2 && !(vxs_iss.acc && vxs_iss.acc_fold), fire)
+      val acc = RegEnable(vxs_iss.acc, fire)
+      val acc_ew = RegEnable(vxs_iss.acc && vxs_iss.acc_ew, fire)
+
+      val resp_rvs1 = vrf.io.vxs(i).rvs1.resp
+      val resp_rvs2 = vrf.io.vxs(i).rvs2.resp
+      val resp_rvd = vrf.io.vxs(i).rvd.resp
+      val late_rvs2_elem = extractElem(resp_rvs2, rvs2_eew, eidx)
+
+      vxu.io.iss_late.rvs1_data.valid := late && vrf_rvs1 && !acc
+      vxu.io.iss_late.rvs1_data.bits  := resp_rvs1
+      vxu.io.iss_late.rvs1_elem.valid := late && vrf_rvs1
+      vxu.io.iss_late.rvs1_elem.bits  := extractElem(resp_rvs1, rvs1_eew, eidx)
+      vxu.io.iss_late.rvs2_data.valid := late && vrf_rvs2
+      vxu.io.iss_late.rvs2_data.bits  := Mux(acc_ew, late_rvs2_elem, resp_rvs2)
+      vxu.io.iss_late.rvs2_elem.valid := late && vrf_rvs2
+      vxu.io.iss_late.rvs2_elem.bits  := late_rvs2_elem
+      vxu.io.iss_late.rvd_data.valid  := late
+      vxu.io.iss_late.rvd_data.bits   := resp_rvd
+      vxu.io.iss_late.rvd_elem.valid  := late
+      vxu.io.iss_late.rvd_elem.bits   := extractElem(resp_rvd, rvd_eew, eidx)
+    }
     vxu.io.iss.bits.viewAsSupertype(new ExecuteMicroOp(vxu.nFUs)) := vxs.io.iss.bits
     
     vxu_iss.altfmt := vxs_iss.altfmt
@@ -356,42 +490,63 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   }
 
   // outer product vrf reads
+  // maccs read rvs1/rvs2 on the first OPU port, moves read rvs2 on the second
   vopu.foreach { vopu =>
+    val macc_port = vrf.io.vxs(flat_vxs.size)
+    val move_port = vrf.io.vxs(flat_vxs.size + 1)
+    for ((vos, port) <- vos.zip(Seq(macc_port, move_port))) {
+      port.rvs1.req <> vos.io.rvs1
+      port.rvs2.req <> vos.io.rvs2
+      port.rvm.req.valid := false.B
+      port.rvm.req.bits := DontCare
+      port.rvd.req.valid := false.B
+      port.rvd.req.bits := DontCare
+      vos.io.iss.ready := true.B
+    }
 
-    vrf.io.vxs(flat_vxs.size).rvs1.req <> vos.get.io.rvs1
-    vrf.io.vxs(flat_vxs.size).rvs2.req <> vos.get.io.rvs2
-    vrf.io.vxs(flat_vxs.size).rvm.req.valid := false.B
-    vrf.io.vxs(flat_vxs.size).rvm.req.bits := DontCare
-    vrf.io.vxs(flat_vxs.size).rvd.req.valid := false.B
-    vrf.io.vxs(flat_vxs.size).rvd.req.bits := DontCare
-    vos.get.io.iss.ready := true.B
+    // the younger of a macc and a move on the same tile waits for the older
+    vos_macc.get.io.tile_stall := vos_move.get.io.tile.valid && vos_macc.get.io.tile.bits === vos_move.get.io.tile.bits && vatOlder(vos_move.get.io.vat, vos_macc.get.io.vat)
+    vos_move.get.io.tile_stall := vos_macc.get.io.tile.valid && vos_macc.get.io.tile.bits === vos_move.get.io.tile.bits && vatOlder(vos_macc.get.io.vat, vos_move.get.io.vat)
 
-    val vopu_ctrl_reg = Reg(new OuterProductControl)
-    vopu_ctrl_reg := vos.get.io.iss.bits
-    when (vos.get.io.iss.valid) {
-      when (vos.get.io.iss.bits.mvin.orR || vos.get.io.iss.bits.mvin_bcast.head) {
-        vopu_ctrl_reg.in_t := vrf.io.vxs(flat_vxs.size).rvs2.resp.asTypeOf(
-          Vec(vopu.xDim, Vec(vopu.clusterXdim, UInt(opuParams.bWidth.W)))
-        )
-      }
+    val maccs = vos_macc.get.io.iss
+    val moves = vos_move.get.io.iss
+    // SRAM VRF banks return the operands the cycle after the read, so they
+    // go to the OPU around the control register
+    def late[T <: Data](x: T): T = if (vParams.vrfSRAM) RegNext(x) else x
+    def lateValid(x: Bool): Bool = if (vParams.vrfSRAM) RegNext(x, false.B) else x
+    val vopu_rvs1 = vopu.opuSlice(macc_port.rvs1.resp, late(vos_macc.get.io.rvs1_slice))
+    val vopu_rvs2 = vopu.opuSlice(macc_port.rvs2.resp, late(vos_macc.get.io.rvs2_slice))
+    val vopu_mvin = vopu.opuSlice(move_port.rvs2.resp, late(vos_move.get.io.rvs2_slice))
 
-      when (vos.get.io.iss.bits.macc.head) {
-        vopu_ctrl_reg.in_l := vrf.io.vxs(flat_vxs.size).rvs1.resp.asTypeOf(
-          Vec(vopu.yDim, Vec(vopu.clusterYdim, UInt(opuParams.aWidth.W)))
-        )
-
-        val elems = vrf.io.vxs(flat_vxs.size).rvs2.resp.asTypeOf(
-          Vec(vopu.xDim * vopu.clusterXdim, UInt(opuParams.bWidth.W))
-        )
-        for (i <- 0 until vopu.xDim) {
-          for (j <- 0 until vopu.clusterXdim) {
-            vopu_ctrl_reg.in_t(i)(j) := elems(i + j * vopu.xDim)
-          }
+    val vopu_ctrl_reg = Reg(new OuterProductControl)
+    val vopu_data = if (vParams.vrfSRAM) WireInit(vopu_ctrl_reg) else vopu_ctrl_reg
+    vopu_ctrl_reg := maccs.bits
+    vopu_ctrl_reg.clock_enable := maccs.bits.clock_enable || moves.bits.clock_enable
+    vopu_ctrl_reg.mv_mrf_idx := moves.bits.mv_mrf_idx
+    vopu_ctrl_reg.row_idx := moves.bits.row_idx
+    vopu_ctrl_reg.col_idx := moves.bits.col_idx
+    vopu_ctrl_reg.mvin := moves.bits.mvin
+    vopu_ctrl_reg.mvin_bcast := moves.bits.mvin_bcast
+    vopu_ctrl_reg.mvout := moves.bits.mvout
+    when (lateValid(moves.valid && (moves.bits.mvin.orR || moves.bits.mvin_bcast.head))) {
+      vopu_data.mvin_data := vopu_mvin.asTypeOf(Vec(vopu.xDim, UInt(opuParams.cWidth.W)))
+    }
+    when (lateValid(maccs.valid && maccs.bits.macc.head)) {
+      vopu_data.in_l := vopu_rvs1.asTypeOf(
+        Vec(vopu.yDim, Vec(vopu.clusterYdim, UInt(opuParams.aWidth.W)))
+      )
+
+      val elems = vopu_rvs2.asTypeOf(
+        Vec(vopu.xDim * vopu.clusterXdim, UInt(opuParams.bWidth.W))
+      )
+      for (i <- 0 until vopu.xDim) {
+        for (j <- 0 until vopu.clusterXdim) {
+          vopu_data.in_t(i)(j) := elems(i + j * vopu.xDim)
         }
       }
     }
 
-    vopu.io.op := vopu_ctrl_reg
+    vopu.io.op := vopu_data
   }
 
 
@@ -409,16 +564,17 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   }
 
 
-  // Sepecial OPU connection
-  vos.foreach { vos =>
-    vrf.io.vxs(flat_vxs.size).pipe_write_req <> vos.io.pipe_write_req
-    vrf.io.pipe_writes(flat_vxs.size).valid := vos.io.write.valid
-    vrf.io.pipe_writes(flat_vxs.size).bits.eg := vos.io.write.bits
-    vrf.io.pipe_writes(flat_vxs.size).bits.data := RegEnable(vopu.get.io.out.asUInt, vos.io.write_reg_enable)
-    vrf.io.pipe_writes(flat_vxs.size).bits.mask := ~(0.U(dLen.W))
-
-    vrf.io.iter_writes(flat_vxs.size).valid := false.B
-    vrf.io.iter_writes(flat_vxs.size).bits := DontCare
+  // Sepecial OPU connection, only mvouts write the VRF
+  vos.zipWithIndex.foreach { case (vos, i) =>
+    val idx = flat_vxs.size + i
+    vrf.io.vxs(idx).pipe_write_req <> vos.io.pipe_write_req
+    vrf.io.pipe_writes(idx).valid := vos.io.write.valid
+    vrf.io.pipe_writes(idx).bits.eg := vos.io.write.bits
+    vrf.io.pipe_writes(idx).bits.data := Fill(opuParams.dimDivisor, RegEnable(vopu.get.io.out.asUInt, vos.io.write_reg_enable))
+    vrf.io.pipe_writes(idx).bits.mask := vos.io.write_mask
+
+    vrf.io.iter_writes(idx).valid := false.B
+    vrf.io.iter_writes(idx).bits := DontCare
   }
 
   val load_write = Wire(Decoupled(new VectorWrite(dLen)))
@@ -442,30 +598,37 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
   // ========================================
   // Connect frontend index/mask access ports
 
-  val index_access_eg = getEgId(io.index_access.vrs, io.index_access.eidx, io.index_access.eew, false.B)
-  val index_access_eg_oh = UIntToOH(index_access_eg)
+  // Frontend accesses are for undispatched instructions, so they see the
+  // latest renaming
+  val index_access_eg = physEg(getEgId(io.index_access.vrs, io.index_access.eidx, io.index_access.eew, false.B), io.vrf_home)
   val index_access_hazard = ((allSeqs.map(_.io.seq_hazard).map { h =>
-    h.valid && ((h.bits.wintent & index_access_eg_oh) =/= 0.U)
+    h.valid && h.bits.wintent.contains(index_access_eg)
   } ++ allIssQs.map(_.io.hazards).flatten.map { h =>
-    h.valid && h.bits.wintent(io.index_access.vrs)
+    h.valid && h.bits.wintent(physVReg(io.index_access.vrs, io.vrf_home))
   } ++ vxus.flatten.map(_.io.pipe_hazards).flatten.map { h =>
     h.valid && h.bits.eg === index_access_eg
   } ++ vxus.flatten.map(_.io.iter_hazards).flatten.map { h =>
     h.valid && h.bits.eg === index_access_eg
   }).orR ||
-    vdq.io.peek.map(i => i.valid && !(i.bits.vmu && i.bits.store)).orR
+    vdq.io.peek.map(i => i.valid && !(i.bits.vmu && i.bits.store)).orR ||
+    (dis_hold_valid && !(dis_hold.vmu && dis_hold.store))
   )
   // TODO: this conservatively assumes a index data hazard against anything in the vdq
 
-  frontend_rindex.req.valid := io.index_access.valid
-  io.index_access.ready := frontend_rindex.req.ready && !index_access_hazard
+  // SRAM VRF banks return the index the cycle after the read, so the
+  // access holds for that cycle
+  val rindex_returned = RegNext(frontend_rindex.req.fire && !index_access_hazard && vParams.vrfSRAM.B, false.B)
+  val rindex_ready = if (vParams.vrfSRAM) rindex_returned else frontend_rindex.req.ready
+
+  frontend_rindex.req.valid := io.index_access.valid && !rindex_returned
+  io.index_access.ready := rindex_ready && !index_access_hazard
   frontend_rindex.req.bits.eg  := index_access_eg
   frontend_rindex.req.bits.oldest  := false.B
   io.index_access.idx   := frontend_rindex.resp >> ((io.index_access.eidx << io.index_access.eew)(dLenOffBits-1,0) << 3) & eewBitMask(io.index_access.eew)
 
   val vm_busy = Wire(Bool())
   frontend_rmask.req.valid    := io.mask_access.valid
-  frontend_rmask.req.bits.eg  := getEgId(0.U, io.mask_access.eidx, 0.U, true.B)
+  frontend_rmask.req.bits.eg  := physEg(getEgId(0.U, io.mask_access.eidx, 0.U, true.B), io.vrf_home)
   frontend_rmask.req.bits.oldest := false.B
   io.mask_access.ready  := frontend_rmask.req.ready && !vm_busy
   io.mask_access.mask   := frontend_rmask.resp >> io.mask_access.eidx(log2Ceil(dLen)-1,0)
@@ -580,24 +743,29 @@ class VectorBackend(implicit p: Parameters) extends CoreModule()(p) with HasVect
 
   // Signalling to frontend
   val seq_inflight_wv0 = (allSeqs.map(_.io.seq_hazard).map { h =>
-    h.valid && ((h.bits.wintent & ~(0.U(egsPerVReg.W))) =/= 0.U)
+    h.valid && h.bits.wintent.touchesV0
   } ++ allIssQs.map(_.io.hazards).flatten.map { h =>
-    h.valid && h.bits.wintent(0)
+    h.valid && (0 until nPhysVRegs by 32).map(h.bits.wintent(_)).orR
   } ++ vxus.flatten.map(_.io.pipe_hazards).flatten.map { h =>
-    h.valid && (h.bits.eg < egsPerVReg.U)
+    h.valid && isV0Eg(h.bits.eg)
   } ++ vxus.flatten.map(_.io.iter_hazards).flatten.map { h =>
-    h.valid && (h.bits.eg < egsPerVReg.U)
+    h.valid && isV0Eg(h.bits.eg)
   }).orR
   val vdq_inflight_wv0 = vdq.io.peek.map { h =>
     h.valid && h.bits.may_write_v0
-  }.orR
+  }.orR || (dis_hold_valid && dis_hold.may_write_v0)
 
   vm_busy := seq_inflight_wv0 || vdq_inflight_wv0
-  io.busy := vdq.io.deq.valid || allSeqs.map(_.io.busy).orR || vxus.flatten.map(_.io.busy).asUInt.orR
+  io.busy := vdq.io.deq.valid || dis_hold_valid || allSeqs.map(_.io.busy).orR || vxus.flatten.map(_.io.busy).asUInt.orR
   io.set_vxsat := vxus.flatten.map(_.io.set_vxsat).asUInt.orR
   io.set_fflags.valid := vxus.flatten.map(_.io.set_fflags.valid).asUInt.orR
   io.set_fflags.bits  := vxus.flatten.map( xu => Mux(xu.io.set_fflags.valid, xu.io.set_fflags.bits, 0.U)).reduce(_|_)
 
+  perf.issq_stall := dis_slots(0).valid && !dis_fire(0)
+  perf.vrf_read_conflict := vrf.io.read_conflict
+  perf.opu_macc := vos_macc.map(s => s.io.iss.valid && s.io.iss.bits.macc.head).getOrElse(false.B)
+  perf.seqs := VecInit(allSeqs.map(_.io.perf))
+
   // Only one of these should actually be connected
   val scalar_write_arb = Module(new Arbiter(new ScalarWrite, flat_vxus.size))
   vxus.flatten.map(_.io.scalar_write).zip(scalar_write_arb.io.in).foreach { case (i,o) => o <> i }
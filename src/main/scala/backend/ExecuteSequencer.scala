@@ -35,11 +35,11 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   val valid = RegInit(false.B)
   val inst  = Reg(new BackendIssueInst)
   val head  = Reg(Bool())
-  val wvd_mask  = Reg(UInt(egsTotal.W))
-  val rvs1_mask = Reg(UInt(egsTotal.W))
-  val rvs2_mask = Reg(UInt(egsTotal.W))
-  val rvd_mask  = Reg(UInt(egsTotal.W))
-  val rvm_mask  = Reg(UInt(egsPerVReg.W))
+  val wvd_mask  = new EgIntent
+  val rvs1_mask = new EgIntent
+  val rvs2_mask = new EgIntent
+  val rvd_mask  = new EgIntent
+  val rvm_mask  = maskIntent()
   val vs1_eew   = Reg(UInt(2.W))
   val vs2_eew   = Reg(UInt(2.W))
   val vs3_eew   = Reg(UInt(2.W))
@@ -60,12 +60,16 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   val eff_vl       = Reg(UInt((1+log2Ceil(maxVLMax)).W))
   val next_eidx    = Reg(UInt((1+log2Ceil(maxVLMax)).W))
   val rgatherei16  = Reg(Bool())
+  val xbar_gather  = Reg(Bool())
+  val gather_eg    = Reg(UInt((log2Ceil(egsPerVReg) max 1).W))
+  val gather_last_eg = Reg(UInt((log2Ceil(egsPerVReg) max 1).W))
   val mvnrr        = Reg(Bool())
   val incr_eew     = Reg(UInt(2.W))
   val increments_as_mask = Reg(Bool())
   val eidx      = Reg(UInt(log2Ceil(maxVLMax).W))
   val acc_fold  = Reg(Bool())
   val acc_fold_id = Reg(UInt(log2Ceil(dLenB).W))
+  val acc_tree  = Reg(Bool())
 
   val compress = inst.opmf6 === OPMFunct6.compress && usesCompress.B
   val acc_copy = (vd_eew === 3.U && (dLenB == 8).B) || elementwise
@@ -75,15 +79,19 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   val rgather    = inst.opif6 === OPIFunct6.rgather && usesPerm.B
   val rgather_ix = rgather && inst.funct3.isOneOf(OPIVX, OPIVI)
   val rgather_v  = rgather && inst.funct3.isOneOf(OPIVV)
+  val eidx_gather = (rgather_v || rgatherei16) && !xbar_gather
+  val gather_done = !xbar_gather || gather_eg === gather_last_eg
+  val eidx_tail = next_eidx === eff_vl
   val renv1    = inst.renv1 && !inst.reduction
   val renv2    = Mux(rgather_ix, head, inst.renv2) && (!inst.reduction || !acc_fold)
   val renvd    = inst.renvd && usesRvd.B
   val renvm    = inst.renvm
-  val renacc   = inst.reduction && usesAcc.B
+  val acc_folds = inst.reduction && usesAcc.B && !acc_tree
+  // Tree reductions sum vs2 inside the FU, and only take vs1[0] with the last element group
+  val renacc   = inst.reduction && usesAcc.B && (!acc_tree || eidx_tail)
 
   val use_wmask = !inst.vm && sets_wmask
-  val eidx_tail = next_eidx === eff_vl
-  val tail      = Mux(inst.reduction && usesAcc.B, acc_fold && acc_last, eidx_tail)
+  val tail      = Mux(acc_folds, acc_fold && acc_last, eidx_tail && gather_done)
 
   io.dis.ready := (!valid || (tail && io.iss.fire)) && !io.dis_stall
 
@@ -91,7 +99,7 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
     val dis_inst = io.dis.bits
 
     val dis_ctrl = Wire(new VectorDecodedControl(supported_insns, Seq(
-      SetsWMask, UsesGatherUnit, Elementwise, UsesNarrowingSext, ZextImm5,
+      SetsWMask, UsesGatherUnit, Elementwise, UsesNarrowingSext, ZextImm5, TreeReduction,
       PipelinedExecution, PipelineStagesMinus1, FUSel(nFUs)
     ))).decode(dis_inst)
 
@@ -109,9 +117,11 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
     val dis_rgatherei16  = dis_inst.funct3 === OPIVV && dis_inst.opif6 === OPIFunct6.rgatherei16 && usesPerm.B
     val dis_rgather_eew  = Mux(dis_inst.opif6 === OPIFunct6.rgatherei16, 1.U, dis_sew)
     val dis_mvnrr         = dis_inst.funct3 === OPIVI && dis_inst.opif6 === OPIFunct6.mvnrr
-    val dis_vd_arch_mask  = get_arch_mask(dis_inst.rd , dis_inst.emul +& dis_inst.wide_vd)
-    val dis_vs1_arch_mask = get_arch_mask(dis_inst.rs1, Mux(dis_inst.reads_vs1_mask, 0.U, dis_inst.emul))
-    val dis_vs2_arch_mask = get_arch_mask(dis_inst.rs2, Mux(dis_inst.reads_vs2_mask, 0.U, dis_inst.emul +& dis_inst.wide_vs2))
+    val dis_xbar_gather   = dis_inst.xbar_gather && usesPerm.B
+    val dis_elementwise   = dis_ctrl.bool(Elementwise) && !dis_xbar_gather
+    val (dis_vd_first , dis_vd_last ) = vregGroup(dis_inst.rd , dis_inst.emul +& dis_inst.wide_vd)
+    val (dis_vs1_first, dis_vs1_last) = vregGroup(dis_inst.rs1, Mux(dis_inst.reads_vs1_mask, 0.U, dis_inst.emul))
+    val (dis_vs2_first, dis_vs2_last) = vregGroup(dis_inst.rs2, Mux(dis_inst.reads_vs2_mask, 0.U, dis_inst.emul +& dis_inst.wide_vs2))
     val dis_eff_vl        = WireInit(dis_inst.vconfig.vl)
     val dis_increments_as_mask = (
       (!dis_inst.renv1 || dis_inst.reads_vs1_mask) &&
@@ -133,17 +143,18 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
     valid         := true.B
     inst          := io.dis.bits
     eidx          := 0.U
-    wvd_mask      := Mux(dis_inst.wvd               , FillInterleaved(egsPerVReg, dis_vd_arch_mask), 0.U)
-    rvs1_mask     := Mux(dis_inst.renv1             , FillInterleaved(egsPerVReg, dis_vs1_arch_mask), 0.U)
-    rvs2_mask     := Mux(dis_inst.renv2             , FillInterleaved(egsPerVReg, dis_vs2_arch_mask), 0.U)
-    rvd_mask      := Mux(dis_inst.renvd && usesRvd.B, FillInterleaved(egsPerVReg, dis_vd_arch_mask), 0.U)
-    rvm_mask      := Mux(dis_inst.renvm             , ~(0.U(egsPerVReg.W)), 0.U)
+    wvd_mask.set (dis_inst.wvd               , dis_vd_first , dis_vd_last , dis_inst.whome)
+    rvs1_mask.set(dis_inst.renv1             , dis_vs1_first, dis_vs1_last, dis_inst.rhome)
+    rvs2_mask.set(dis_inst.renv2             , dis_vs2_first, dis_vs2_last, dis_inst.rhome)
+    rvd_mask.set (dis_inst.renvd && usesRvd.B, dis_vd_first , dis_vd_last , dis_inst.rhome)
+    rvm_mask.set (dis_inst.renvm             , 0.U          , 0.U         , dis_inst.rhome)
     head          := true.B
     acc_fold      := false.B
     acc_fold_id   := 0.U
+    acc_tree      := dis_ctrl.bool(TreeReduction)
     sets_wmask    := dis_ctrl.bool(SetsWMask)
-    uses_perm     := dis_ctrl.bool(UsesGatherUnit) && usesPerm.B
-    elementwise   := dis_ctrl.bool(Elementwise)
+    uses_perm     := dis_ctrl.bool(UsesGatherUnit) && usesPerm.B && !dis_xbar_gather
+    elementwise   := dis_elementwise
     zext_imm5     := dis_ctrl.bool(ZextImm5)
     pipelined     := dis_ctrl.bool(PipelinedExecution)
     pipe_stages   := dis_ctrl.uint(PipelineStagesMinus1)
@@ -151,13 +162,16 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
     slide         := dis_slide
     rgatherei16   := dis_rgatherei16
     mvnrr         := dis_mvnrr
+    xbar_gather   := dis_xbar_gather
+    gather_eg     := 0.U
+    gather_last_eg := ((dis_vlmax << dis_sew) - 1.U) >> dLenOffBits
     vs1_eew       := dis_vs1_eew
     vs2_eew       := dis_vs2_eew
     vs3_eew       := dis_vs3_eew
     vd_eew        := dis_vd_eew
     eff_vl        := dis_eff_vl
     incr_eew      := dis_incr_eew
-    next_eidx     := get_next_eidx(dis_eff_vl, 0.U, dis_incr_eew, 0.U, dis_increments_as_mask, dis_ctrl.bool(Elementwise), dLen)
+    next_eidx     := get_next_eidx(dis_eff_vl, 0.U, dis_incr_eew, 0.U, dis_increments_as_mask, dis_elementwise, dLen)
     increments_as_mask := dis_increments_as_mask
 
     when (dis_mvnrr) {
@@ -194,31 +208,34 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
 
   io.vat := inst.vat
   io.seq_hazard.valid := valid
-  io.seq_hazard.bits.rintent := hazardMultiply(rvs1_mask | rvs2_mask | rvd_mask | rvm_mask)
-  io.seq_hazard.bits.wintent := hazardMultiply(wvd_mask)
+  io.seq_hazard.bits.rintent := intents(4, rvs1_mask, rvs2_mask, rvd_mask, rvm_mask)
+  io.seq_hazard.bits.wintent := intents(1, wvd_mask)
   io.seq_hazard.bits.vat := inst.vat
 
-  val vs1_read_oh = Mux(renv1   , UIntToOH(io.rvs1.bits.eg), 0.U)
-  val vs2_read_oh = Mux(renv2   , UIntToOH(io.rvs2.bits.eg), 0.U)
-  val vd_read_oh  = Mux(renvd   , UIntToOH(io.rvd.bits.eg ), 0.U)
-  val vm_read_oh  = Mux(renvm   , UIntToOH(io.rvm.bits.eg ), 0.U)
-  val vd_write_oh = Mux(inst.wvd, UIntToOH(io.iss.bits.wvd_eg), 0.U)
-
-  val raw_hazard = ((vs1_read_oh | vs2_read_oh | vd_read_oh | vm_read_oh) & io.older_writes) =/= 0.U
-  val waw_hazard = (vd_write_oh & io.older_writes) =/= 0.U
-  val war_hazard = (vd_write_oh & io.older_reads) =/= 0.U
+  val hazards = checkHazards(Seq(
+    (renv1, io.rvs1.bits.eg),
+    (renv2, io.rvs2.bits.eg),
+    (renvd, io.rvd.bits.eg),
+    (renvm, io.rvm.bits.eg)),
+    (inst.wvd, io.iss.bits.wvd_eg))
+  val raw_hazard = hazards.raw
+  val waw_hazard = hazards.waw
+  val war_hazard = hazards.war
   val data_hazard = raw_hazard || waw_hazard || war_hazard
 
   val rgatherv_e0_eidx = io.vgu.gather_eidx.bits
   val rgather_eidx = Mux(rgather_ix, uscalar, rgatherv_e0_eidx)
   val rgather_zero = rgather_eidx >= inst.vconfig.vtype.vlMax
-  io.rvs1.bits.eg := getEgId(inst.rs1, eidx     , vs1_eew, inst.reads_vs1_mask)
-  io.rvs2.bits.eg := Mux(rgather || rgatherei16,
-    getEgId(inst.rs2, rgather_eidx, vs2_eew, false.B),
-    getEgId(inst.rs2, eidx        , vs2_eew, inst.reads_vs2_mask)
-  )
-  io.rvd.bits.eg  := getEgId(inst.rd , eidx     , vs3_eew, false.B)
-  io.rvm.bits.eg  := getEgId(0.U     , eidx     , 0.U    , true.B)
+  io.rvs1.bits.eg := physEg(getEgId(inst.rs1, eidx     , vs1_eew, inst.reads_vs1_mask), inst.rhome)
+  io.rvs2.bits.eg := physEg(Mux(xbar_gather,
+    getEgId(inst.rs2, 0.U, vs2_eew, false.B) + gather_eg,
+    Mux(rgather || rgatherei16,
+      getEgId(inst.rs2, rgather_eidx, vs2_eew, false.B),
+      getEgId(inst.rs2, eidx        , vs2_eew, inst.reads_vs2_mask)
+    )
+  ), inst.rhome)
+  io.rvd.bits.eg  := physEg(getEgId(inst.rd , eidx     , vs3_eew, false.B), inst.rhome)
+  io.rvm.bits.eg  := physEg(getEgId(0.U     , eidx     , 0.U    , true.B), inst.rhome)
 
   io.rvs1.valid := valid && renv1
   io.rvs2.valid := valid && renv2
@@ -237,7 +254,7 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   exu_scheduler.io.reqs(0).fire := io.iss.fire
   exu_scheduler.io.reqs(0).depth := pipe_stages
 
-  val wvd_eg = getEgId(inst.rd, Mux(inst.reduction, 0.U, eidx), vd_eew, inst.writes_mask)
+  val wvd_eg = physEg(getEgId(inst.rd, Mux(inst.reduction, 0.U, eidx), vd_eew, inst.writes_mask), inst.whome)
   io.pipe_write_req.request := valid && pipelined && exu_scheduler.io.reqs(0).available
   io.pipe_write_req.bank_sel := (if (vrfBankBits == 0) 1.U else UIntToOH(wvd_eg(vrfBankBits-1,0)))
   io.pipe_write_req.pipe_depth := pipe_stages
@@ -251,7 +268,7 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   val read_slide_buffer = slide && Mux(slide_up,
     next_eidx > slide_offset,
     eidx +& slide_offset < inst.vconfig.vtype.vlMax)
-  val read_eidx_buffer = rgather_v || rgatherei16
+  val read_eidx_buffer = eidx_gather
 
   io.vgu.slide_req.bits.head := (if (usesPerm) slide_head else 0.U)
   io.vgu.slide_req.bits.tail := (if (usesPerm) slide_tail else 0.U)
@@ -282,6 +299,7 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   io.iss.bits.eidx      := eidx
   io.iss.bits.vl        := inst.vconfig.vl
   io.iss.bits.wvd_eg    := wvd_eg
+  io.iss.bits.whome     := inst.whome
   io.iss.bits.rs1       := inst.rs1
   io.iss.bits.rs2       := inst.rs2
   io.iss.bits.rd        := inst.rd
@@ -321,39 +339,44 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   io.iss.bits.use_slide_rvs2 := slide
   io.iss.bits.slide_data := io.vgu.slide_data & slide_down_bit_mask
 
-  io.iss.bits.use_scalar_rvs1 := inst.funct3.isOneOf(OPIVI, OPIVX, OPMVX, OPFVF) || rgather_v || rgatherei16
-  io.iss.bits.scalar := Mux(rgather_v || rgatherei16,
+  io.iss.bits.use_scalar_rvs1 := inst.funct3.isOneOf(OPIVI, OPIVX, OPMVX, OPFVF) || eidx_gather
+  io.iss.bits.scalar := Mux(eidx_gather,
     rgather_eidx,
-    Mux(zext_imm5, uscalar, sscalar))
-  io.iss.bits.use_zero_rvs2 := rgather_zero && (rgather || rgatherei16)
+    Mux(xbar_gather, inst.vconfig.vtype.vlMax, Mux(zext_imm5, uscalar, sscalar)))
+  io.iss.bits.use_zero_rvs2 := rgather_zero && (rgather || rgatherei16) && !xbar_gather
+  io.iss.bits.xbar_gather := xbar_gather
+  io.iss.bits.gather_eg := gather_eg
 
-  io.iss.bits.acc       := inst.reduction && usesAcc.B
+  io.iss.bits.acc       := renacc
   io.iss.bits.acc_copy  := acc_copy
   io.iss.bits.acc_fold  := acc_fold
   io.iss.bits.acc_fold_id := acc_fold_id
   io.iss.bits.acc_ew      := elementwise
 
 
-  when (io.iss.fire && !tail) {
+  when (io.iss.fire && xbar_gather) {
+    gather_eg := Mux(gather_done, 0.U, gather_eg + 1.U)
+  }
+
+  when (io.iss.fire && !tail && gather_done) {
     if (vParams.enableChaining) {
       when (next_is_new_eg(eidx, next_eidx, vd_eew, inst.writes_mask) && !inst.reduction && !compress) {
-        val wvd_clr_mask = UIntToOH(io.iss.bits.wvd_eg)
-        wvd_mask  := wvd_mask  & ~wvd_clr_mask
+        wvd_mask.clear(io.iss.bits.wvd_eg)
       }
       when (next_is_new_eg(eidx, next_eidx, vs2_eew, inst.reads_vs2_mask) && !(inst.reduction && head) && !rgather_v && !rgatherei16) {
-        rvs2_mask := rvs2_mask & ~UIntToOH(io.rvs2.bits.eg)
+        rvs2_mask.clear(io.rvs2.bits.eg)
       }
       when (rgather_ix) {
-        rvs2_mask := 0.U
+        rvs2_mask.clearAll()
       }
       when (next_is_new_eg(eidx, next_eidx, vs1_eew, inst.reads_vs1_mask)) {
-        rvs1_mask := rvs1_mask & ~UIntToOH(io.rvs1.bits.eg)
+        rvs1_mask.clear(io.rvs1.bits.eg)
       }
       when (next_is_new_eg(eidx, next_eidx, vs3_eew, false.B)) {
-        rvd_mask  := rvd_mask  & ~UIntToOH(io.rvd.bits.eg)
+        rvd_mask.clear(io.rvd.bits.eg)
       }
       when (next_is_new_eg(eidx, next_eidx, 0.U    , true.B)) {
-        rvm_mask  := rvm_mask  & ~UIntToOH(io.rvm.bits.eg)
+        rvm_mask.clear(io.rvm.bits.eg)
       }
     }
 
@@ -362,7 +385,7 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
     next_eidx := next_next_eidx
 
     if (usesAcc) {
-      when (eidx_tail) { acc_fold := true.B }
+      when (eidx_tail && !acc_tree) { acc_fold := true.B }
       when (acc_fold) { acc_fold_id := acc_fold_id + 1.U }
     }
 
@@ -381,7 +404,12 @@ class ExecuteSequencer(supported_insns: Seq[VectorInstruction], maxPipeDepth: In
   }
 
   io.busy := valid
+  io.perf.busy := valid
+  io.perf.issue := io.iss.fire
+  io.perf.raw := valid && raw_hazard
+  io.perf.waw := valid && waw_hazard
+  io.perf.war := valid && war_hazard
   io.head := head
 
-  if (!usesRvd) { rvd_mask := 0.U }
+  if (!usesRvd) { rvd_mask.clearAll() }
 }
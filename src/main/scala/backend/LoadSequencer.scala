@@ -18,8 +18,8 @@ class LoadSequencer(implicit p: Parameters) extends Sequencer[LoadRespMicroOp]()
   val inst  = Reg(new BackendIssueInst)
   val eidx  = Reg(UInt(log2Ceil(maxVLMax).W))
   val sidx  = Reg(UInt(3.W))
-  val wvd_mask = Reg(UInt(egsTotal.W))
-  val rvm_mask = Reg(UInt(egsPerVReg.W))
+  val wvd_mask = new EgIntent
+  val rvm_mask = maskIntent()
   val head     = Reg(Bool())
 
   val renvm     = !inst.vm
@@ -35,14 +35,10 @@ class LoadSequencer(implicit p: Parameters) extends Sequencer[LoadRespMicroOp]()
     eidx  := iss_inst.vstart
     sidx  := iss_inst.segstart
 
-    val wvd_arch_mask = Wire(Vec(32, Bool()))
-    for (i <- 0 until 32) {
-      val group = i.U >> iss_inst.emul
-      val rd_group = iss_inst.rd >> iss_inst.emul
-      wvd_arch_mask(i) := group >= rd_group && group <= (rd_group + iss_inst.nf)
-    }
-    wvd_mask := FillInterleaved(egsPerVReg, wvd_arch_mask.asUInt)
-    rvm_mask := Mux(!iss_inst.vm, ~(0.U(egsPerVReg.W)), 0.U)
+    val rd_group = iss_inst.rd >> iss_inst.emul
+    val wvd_last = ((rd_group +& iss_inst.nf +& 1.U) << iss_inst.emul) - 1.U
+    wvd_mask.set(true.B, rd_group << iss_inst.emul, Mux(wvd_last > 31.U, 31.U, wvd_last), iss_inst.whome)
+    rvm_mask.set(!iss_inst.vm, 0.U, 0.U, iss_inst.rhome)
     head := true.B
   } .elsewhen (io.iss.fire) {
     valid := !tail
@@ -51,24 +47,22 @@ class LoadSequencer(implicit p: Parameters) extends Sequencer[LoadRespMicroOp]()
 
   io.vat := inst.vat
   io.seq_hazard.valid := valid
-  io.seq_hazard.bits.rintent := hazardMultiply(rvm_mask)
-  io.seq_hazard.bits.wintent := hazardMultiply(wvd_mask)
+  io.seq_hazard.bits.rintent := intents(4, rvm_mask)
+  io.seq_hazard.bits.wintent := intents(1, wvd_mask)
   io.seq_hazard.bits.vat     := inst.vat
 
-  val vm_read_oh  = Mux(renvm, UIntToOH(io.rvm.bits.eg), 0.U)
-  val vd_write_oh = UIntToOH(io.iss.bits.wvd_eg)
-
-  val raw_hazard = (vm_read_oh & io.older_writes) =/= 0.U
-  val waw_hazard = (vd_write_oh & io.older_writes) =/= 0.U
-  val war_hazard = (vd_write_oh & io.older_reads) =/= 0.U
+  val hazards = checkHazards(Seq((renvm, io.rvm.bits.eg)), (true.B, io.iss.bits.wvd_eg))
+  val raw_hazard = hazards.raw
+  val waw_hazard = hazards.waw
+  val war_hazard = hazards.war
   val data_hazard = raw_hazard || waw_hazard || war_hazard
 
   io.rvm.valid := valid && renvm
-  io.rvm.bits.eg := getEgId(0.U, eidx, 0.U, true.B)
+  io.rvm.bits.eg := physEg(getEgId(0.U, eidx, 0.U, true.B), inst.rhome)
   io.rvm.bits.oldest := inst.vat === io.vat_head
 
   io.iss.valid := valid && !data_hazard && (!renvm || io.rvm.ready)
-  io.iss.bits.wvd_eg    := getEgId(inst.rd + (sidx << inst.emul), eidx, inst.mem_elem_size, false.B)
+  io.iss.bits.wvd_eg    := physEg(getEgId(inst.rd + (sidx << inst.emul), eidx, inst.mem_elem_size, false.B), inst.whome)
   io.iss.bits.tail       := tail
   io.iss.bits.vat        := inst.vat
   io.iss.bits.debug_id   := inst.debug_id
@@ -83,10 +77,10 @@ class LoadSequencer(implicit p: Parameters) extends Sequencer[LoadRespMicroOp]()
   when (io.iss.fire && !tail) {
     if (vParams.enableChaining) {
       when (next_is_new_eg(eidx, next_eidx, inst.mem_elem_size, false.B)) {
-        wvd_mask := wvd_mask & ~vd_write_oh
+        wvd_mask.clear(io.iss.bits.wvd_eg)
       }
       when (next_is_new_eg(eidx, next_eidx, 0.U, true.B)) {
-        rvm_mask := rvm_mask & ~UIntToOH(io.rvm.bits.eg)
+        rvm_mask.clear(io.rvm.bits.eg)
       }
     }
     when (sidx === inst.seg_nf) {
@@ -98,5 +92,10 @@ class LoadSequencer(implicit p: Parameters) extends Sequencer[LoadRespMicroOp]()
   }
 
   io.busy := valid
+  io.perf.busy := valid
+  io.perf.issue := io.iss.fire
+  io.perf.raw := valid && raw_hazard
+  io.perf.waw := valid && waw_hazard
+  io.perf.war := valid && war_hazard
   io.head := head
 }
@@ -16,17 +16,30 @@ class OuterProductSequencerIO(implicit p: Parameters) extends SequencerIO(new Ou
   val rvs1 = Decoupled(new VectorReadReq)
   val rvs2 = Decoupled(new VectorReadReq)
 
-  val pipe_write_req = new VectorPipeWriteReqIO(yDim+2)
+  val pipe_write_req = new VectorPipeWriteReqIO(mvoutLatency)
+
+  // opuLen-bit slices of the rvs1/rvs2 responses consumed this cycle
+  val rvs1_slice = Output(UInt((sliceBits max 1).W))
+  val rvs2_slice = Output(UInt((sliceBits max 1).W))
 
   val tail = Output(Bool())
   val write = Output(Valid(UInt(log2Ceil(egsTotal).W)))
   val write_reg_enable = Output(Bool())
+  val write_mask = Output(UInt(dLen.W))
   val wsboard = Output(UInt(egsTotal.W))
+
+  // matrix register in use, younger instructions on the same tile wait
+  val tile = Output(Valid(UInt(tileIdxBits.W)))
+  val tile_stall = Input(Bool())
 }
 
-class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProductControl]()(p) with HasOPUParams {
+// One instance sequences the maccs, another the mvin/mvouts, so that
+// moves on one matrix register overlap with maccs on another
+class OuterProductSequencer(val maccs: Boolean)(implicit p: Parameters) extends Sequencer[OuterProductControl]()(p) with HasOPUParams {
+
+  val opu_insns = if (maccs) opuParams.maccInsns else opuParams.moveInsns
 
-  val opu_insns = vParams.opuInsns
+  require(yDim >= 2 && varchRatio >= 2, "OPU array too small for dLen/dimDivisor")
 
   def accepts(inst: VectorIssueInst) = !inst.vmu && new VectorDecoder(inst, opu_insns, Nil).matched
 
@@ -43,23 +56,30 @@ class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProdu
   val inst = Reg(new BackendIssueInst)
   val head = Reg(Bool())
 
-  val wvd_mask = Reg(UInt(egsTotal.W))
-  val rvs1_mask = Reg(UInt(egsTotal.W))
-  val rvs2_mask = Reg(UInt(egsTotal.W))
+  val wvd_mask = new EgIntent
+  val rvs1_mask = new EgIntent
+  val rvs2_mask = new EgIntent
 
   val mvin = Reg(Bool())
   val mvin_bcast = Reg(Bool())
   val mvout = Reg(Bool())
   val macc = Reg(Bool())
-
-  val scalar_row_idx = inst.rs1_data
-  val scalar_cluster_row_idx = (scalar_row_idx >> log2Ceil(clusterYdim))(log2Ceil(yDim)-1,0)
-  // row0 takes the longest
-  val scalar_row_latency = ((yDim+1).U - scalar_cluster_row_idx)
+  val macc_fp = Reg(Bool())
 
   // maccs use both col_idx and row_idx, mvins/mvouts use col_idx only
-  val col_idx = Reg(UInt(log2Ceil(wideningFactor * (vLen / dLen)).W))
-  val row_idx = Reg(UInt(log2Ceil(vLen / dLen).W))
+  // Both count opuLen-bit slices, so each element group spans 1 << sliceBits indices
+  // A mvout into a register group wider than one tile row (LMUL > wideningFactor)
+  // moves consecutive rows, one per wideningFactor vregs
+  val rowEGBits = log2Ceil(wideningFactor * varchRatio)
+  val maxMvoutRowBits = 3 - log2Ceil(wideningFactor)
+  val col_idx = Reg(UInt((rowEGBits + maxMvoutRowBits).W))
+  val row_idx = Reg(UInt(log2Ceil(varchRatio).W))
+  def sliceOf(idx: UInt) = if (sliceBits == 0) 0.U else idx(sliceBits-1,0)
+  def sliceTail(idx: UInt) = if (sliceBits == 0) true.B else idx(sliceBits-1,0).andR
+
+  val mvout_row_bits = Mux(inst.emul > log2Ceil(wideningFactor).U, inst.emul - log2Ceil(wideningFactor).U, 0.U)
+  val scalar_row_idx = inst.rs1_data + Mux(mvout, col_idx >> rowEGBits, 0.U)
+  val scalar_cluster_row_idx = (scalar_row_idx >> log2Ceil(clusterYdim))(log2Ceil(yDim)-1,0)
 
   val renv1 = macc
   val renv2 = macc || mvin || mvin_bcast
@@ -67,8 +87,10 @@ class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProdu
   val next_col_idx = col_idx +& 1.U
   val next_row_idx = row_idx +& 1.U
 
-  val col_idx_tail = next_col_idx === Mux(macc, (vLen / dLen).U, (wideningFactor * vLen / dLen).U)
-  val row_idx_tail = next_row_idx === (vLen / dLen).U
+  val col_idx_tail = next_col_idx === Mux(macc, varchRatio.U, Mux(mvout,
+    (wideningFactor * varchRatio).U << mvout_row_bits,
+    (wideningFactor * varchRatio).U))
+  val row_idx_tail = next_row_idx === varchRatio.U
 
   val macc_tail = col_idx_tail && row_idx_tail
 
@@ -80,20 +102,22 @@ class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProdu
   when (io.dis.fire) {
     val dis_inst = io.dis.bits
 
-    val dis_vd_arch_mask  = get_arch_mask(dis_inst.rd , 0.U)
-    val dis_vs1_arch_mask = get_arch_mask(dis_inst.rs1, dis_inst.emul)
-    val dis_vs2_arch_mask = get_arch_mask(dis_inst.rs2, dis_inst.emul)
+    val dis_vd_emul = Mux(dis_inst.emul < log2Ceil(wideningFactor).U, log2Ceil(wideningFactor).U, dis_inst.emul)
+    val (dis_vd_first , dis_vd_last ) = vregGroup(dis_inst.rd , dis_vd_emul)
+    val (dis_vs1_first, dis_vs1_last) = vregGroup(dis_inst.rs1, dis_inst.emul)
+    val (dis_vs2_first, dis_vs2_last) = vregGroup(dis_inst.rs2, dis_inst.emul)
 
     valid := true.B
     inst := io.dis.bits
-    wvd_mask      := Mux(dis_inst.wvd               , FillInterleaved(egsPerVReg, dis_vd_arch_mask), 0.U)
-    rvs1_mask     := Mux(dis_inst.renv1             , FillInterleaved(egsPerVReg, dis_vs1_arch_mask), 0.U)
-    rvs2_mask     := Mux(dis_inst.renv2             , FillInterleaved(egsPerVReg, dis_vs2_arch_mask), 0.U)
+    wvd_mask.set (dis_inst.wvd  , dis_vd_first , dis_vd_last , dis_inst.whome)
+    rvs1_mask.set(dis_inst.renv1, dis_vs1_first, dis_vs1_last, dis_inst.rhome)
+    rvs2_mask.set(dis_inst.renv2, dis_vs2_first, dis_vs2_last, dis_inst.rhome)
     val funct6 = OPMFunct6(dis_inst.funct6)
-    mvin := funct6 === OPMFunct6.opmvin
-    mvout :=  funct6 === OPMFunct6.opmvout
-    macc :=  funct6 === OPMFunct6.opmacc
-    mvin_bcast :=  funct6 === OPMFunct6.opmvinbcast
+    mvin := (!maccs).B && funct6 === OPMFunct6.opmvin
+    mvout := (!maccs).B && funct6 === OPMFunct6.opmvout
+    macc := maccs.B && (funct6 === OPMFunct6.opmacc || funct6 === OPMFunct6.opmacci)
+    macc_fp := maccs.B && funct6 === OPMFunct6.opmacc
+    mvin_bcast := (!maccs).B && funct6 === OPMFunct6.opmvinbcast
     col_idx := 0.U
     row_idx := 0.U
     head := true.B
@@ -102,28 +126,29 @@ class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProdu
     head := false.B
   }
 
-  val wvd_eg = ((inst.rd << log2Ceil(egsPerVReg)) +& col_idx)(log2Ceil(egsTotal)-1,0)
+  val wvd_eg = physEg(((inst.rd << log2Ceil(egsPerVReg)) +& (col_idx >> sliceBits))(log2Ceil(egsTotal)-1,0), inst.whome)
 
   // report hazards
   io.vat := inst.vat
   io.seq_hazard.valid := valid
-  io.seq_hazard.bits.rintent := hazardMultiply(rvs1_mask | rvs2_mask)
-  io.seq_hazard.bits.wintent := hazardMultiply(wvd_mask)
+  io.seq_hazard.bits.rintent := intents(4, rvs1_mask, rvs2_mask)
+  io.seq_hazard.bits.wintent := intents(1, wvd_mask)
   io.seq_hazard.bits.vat := inst.vat
   io.wsboard := wsboard
+  io.tile.valid := valid
+  io.tile.bits := Mux(mvout, inst.rs2, inst.rd)
 
-  val vs1_read_oh = Mux(renv1   , UIntToOH(io.rvs1.bits.eg), 0.U)
-  val vs2_read_oh = Mux(renv2   , UIntToOH(io.rvs2.bits.eg), 0.U)
-  val vd_write_oh = Mux(mvout   , UIntToOH(wvd_eg), 0.U)
-
-  val raw_hazard = ((vs1_read_oh | vs2_read_oh) & io.older_writes) =/= 0.U
-  val waw_hazard = (vd_write_oh & io.older_writes) =/= 0.U
-  val war_hazard = (vd_write_oh & io.older_reads) =/= 0.U
+  val hazards = checkHazards(Seq((renv1, io.rvs1.bits.eg), (renv2, io.rvs2.bits.eg)), (mvout, wvd_eg))
+  val raw_hazard = hazards.raw
+  val waw_hazard = hazards.waw
+  val war_hazard = hazards.war
   val data_hazard = raw_hazard || waw_hazard || war_hazard
 
   // element group we are reading
-  io.rvs1.bits.eg := ((inst.rs1 << log2Ceil(egsPerVReg)) +& row_idx)(log2Ceil(egsTotal)-1,0)
-  io.rvs2.bits.eg := ((inst.rs2 << log2Ceil(egsPerVReg)) +& col_idx)(log2Ceil(egsTotal)-1,0)
+  io.rvs1.bits.eg := physEg(((inst.rs1 << log2Ceil(egsPerVReg)) +& (row_idx >> sliceBits))(log2Ceil(egsTotal)-1,0), inst.rhome)
+  io.rvs2.bits.eg := physEg(((inst.rs2 << log2Ceil(egsPerVReg)) +& (col_idx >> sliceBits))(log2Ceil(egsTotal)-1,0), inst.rhome)
+  io.rvs1_slice := sliceOf(row_idx)
+  io.rvs2_slice := sliceOf(col_idx)
 
   io.rvs1.valid := valid && renv1
   io.rvs2.valid := valid && renv2
@@ -132,107 +157,114 @@ class OuterProductSequencer(implicit p: Parameters) extends Sequencer[OuterProdu
   io.rvs1.bits.oldest := oldest
   io.rvs2.bits.oldest := oldest
 
-  // this avoids write-structural-conflicts from the OPU
-  val exu_scheduler = Module(new PipeScheduler(1, yDim+2))
-  exu_scheduler.io.reqs(0).request := valid && mvout
-  exu_scheduler.io.reqs(0).fire := io.iss.fire
-  exu_scheduler.io.reqs(0).depth := scalar_row_latency
-
+  // mvouts of all rows share one latency, so they never conflict with each other
   // this avoids write-structural-hazards on bank ports with other FUs (maybe)
-  io.pipe_write_req.request := valid && mvout && exu_scheduler.io.reqs(0).available
+  io.pipe_write_req.request := valid && mvout
   io.pipe_write_req.bank_sel := (if (vrfBankBits == 0) 1.U else UIntToOH(wvd_eg(vrfBankBits-1,0)))
-  io.pipe_write_req.pipe_depth := scalar_row_latency
+  io.pipe_write_req.pipe_depth := (mvoutLatency-1).U
   io.pipe_write_req.oldest := oldest
   io.pipe_write_req.fire := io.iss.fire
 
   val iss_valid = (valid &&
     !data_hazard &&
+    !io.tile_stall &&
     !(renv1 && !io.rvs1.ready) &&
     !(renv2 && !io.rvs2.ready) &&
-    !(mvout && !io.pipe_write_req.available) &&
-    !(mvout && !exu_scheduler.io.reqs(0).available)
+    !(mvout && !io.pipe_write_req.available)
   )
 
   io.iss.valid := iss_valid
   io.iss.bits.in_l := DontCare // set in Backend
   io.iss.bits.in_t := DontCare
+  io.iss.bits.mvin_data := DontCare
 
 
   // set the control signals
   val mrf_row_idx = Mux(macc,
     row_idx,
     scalar_row_idx >> log2Ceil(yDim * clusterYdim),
-  )(log2Ceil(vLen / dLen)-1,0)
+  )(log2Ceil(varchRatio)-1,0)
   val mrf_col_idx = Mux(macc,
     col_idx,
     col_idx >> log2Ceil(opuParams.cWidth / opuParams.bWidth)
-  )(log2Ceil(vLen / dLen)-1,0)
+  )(log2Ceil(varchRatio)-1,0)
 
-  // mvout_pipe tracks the inflight write destinations
-  val mvout_pipe = Reg(Vec(yDim+2, UInt(log2Ceil(egsTotal).W)))
-  val mvout_valids = RegInit(0.U((yDim+2).W))
+  // mvout_pipe tracks the inflight write destinations, as Cat(eg, slice)
+  val mvout_pipe = Reg(Vec(mvoutLatency, UInt((log2Ceil(egsTotal) + sliceBits).W)))
+  val mvout_valids = RegInit(0.U(mvoutLatency.W))
 
   // high bit is the tile-sel, then the quadrant sel (mrf_row_idx, mrf_col_idx)
-  io.iss.bits.mrf_idx.foreach(_ := Mux(io.iss.fire, Cat(
+  val mrf_idx = Cat(
     Mux(mvout, inst.rs2, inst.rd),
     mrf_row_idx,
     mrf_col_idx
-  ), 0.U))
+  )
+  io.iss.bits.mrf_idx.foreach(_ := Mux(io.iss.fire && macc, mrf_idx, 0.U))
+  io.iss.bits.mv_mrf_idx.foreach(_ := Mux(io.iss.fire && !macc, mrf_idx, 0.U))
   io.iss.bits.row_idx.foreach(_ := Mux(io.iss.fire, scalar_row_idx, 0.U))
   io.iss.bits.col_idx.foreach(_ := Mux(io.iss.fire, col_idx, 0.U))
   io.iss.bits.macc.foreach(_ := io.iss.fire && macc)
   io.iss.bits.mvin_bcast.foreach(_ := io.iss.fire && mvin_bcast)
   io.iss.bits.clock_enable := valid || mvout_valids =/= 0.U
   io.iss.bits.altfmt := inst.vconfig.vtype.altfmt
+  io.iss.bits.fp := macc_fp
 
   // for a non-bcast mvin, only the specific row of clusters gets mvin set
   for (i <- 0 until yDim) {
     io.iss.bits.mvin(i) := io.iss.fire && mvin && scalar_cluster_row_idx === i.U
   }
 
-  mvout_valids := (mvout_valids << 1) | ((io.iss.fire && mvout) << scalar_cluster_row_idx)
-
-  // if the row above us has a valid thing being mv'd out, we have to shift that in
-  io.iss.bits.shift.foreach(_ := false.B)
-  for (i <- 1 until yDim) {
-    when (mvout_valids(i-1)) { mvout_pipe(i) := mvout_pipe(i-1) }
-    io.iss.bits.shift(i) := mvout_valids(i-1)
+  // only the addressed row of clusters drives the readout
+  for (i <- 0 until yDim) {
+    io.iss.bits.mvout(i) := io.iss.fire && mvout && scalar_cluster_row_idx === i.U
   }
 
-  for (i <- 0 until yDim) {
-    when (io.iss.fire && mvout && i.U === scalar_cluster_row_idx) {
-      mvout_pipe(i) := wvd_eg
-    }
+  mvout_valids := (mvout_valids << 1) | (io.iss.fire && mvout)
+  when (io.iss.fire && mvout) {
+    mvout_pipe(0) := (if (sliceBits == 0) wvd_eg else Cat(wvd_eg, sliceOf(col_idx)))
+  }
+  for (i <- 1 until mvoutLatency) {
+    when (mvout_valids(i-1)) { mvout_pipe(i) := mvout_pipe(i-1) }
   }
 
-  when (mvout_valids(yDim-1)) { mvout_pipe(yDim) := mvout_pipe(yDim-1) }
-  when (mvout_valids(yDim)) { mvout_pipe(yDim+1) := mvout_pipe(yDim) }
   // When it leave the mvout pipe, then we do the write
-  io.write.valid := mvout_valids(yDim+1)
-  io.write.bits := mvout_pipe(yDim+1)
-  io.write_reg_enable := mvout_valids(yDim)
+  val write_slice = sliceOf(mvout_pipe(mvoutLatency-1))
+  io.write.valid := mvout_valids(mvoutLatency-1)
+  io.write.bits := mvout_pipe(mvoutLatency-1) >> sliceBits
+  io.write_reg_enable := mvout_valids(mvoutLatency-2)
+  io.write_mask := (if (sliceBits == 0) ~(0.U(dLen.W)) else FillInterleaved(opuLen, UIntToOH(write_slice)))
 
-  // clear the wsboard when we do a write
-  wsboard_clear := (mvout_valids(yDim+1) << mvout_pipe(yDim+1))
+  // clear the wsboard when the last slice of an eg is written
+  wsboard_clear := ((mvout_valids(mvoutLatency-1) && sliceTail(mvout_pipe(mvoutLatency-1))) << io.write.bits)
 
   // update counters
   when (io.iss.fire && !tail) {
-    when (!macc || row_idx_tail) {
-      rvs2_mask := rvs2_mask & ~UIntToOH(io.rvs2.bits.eg)
+    // release a source eg only once its last slice has been read
+    when ((!macc || row_idx_tail) && sliceTail(col_idx)) {
+      rvs2_mask.clear(io.rvs2.bits.eg)
+    }
+    when (col_idx_tail && sliceTail(row_idx)) {
+      rvs1_mask.clear(io.rvs1.bits.eg)
     }
-    rvs1_mask := rvs1_mask & ~UIntToOH(io.rvs1.bits.eg)
 
     col_idx := next_col_idx
     when (col_idx_tail) {
       col_idx := 0.U
       row_idx := next_row_idx
     }
-    when (mvout) {
+    // slices of an eg are written in order, so only the last needs tracking;
+    // wvd_mask covers the eg until then
+    when (mvout && sliceTail(col_idx)) {
       wsboard_write := UIntToOH(wvd_eg)
     }
   }
 
   io.busy := valid
+  io.perf.busy := valid
+  io.perf.issue := io.iss.fire
+  io.perf.raw := valid && raw_hazard
+  io.perf.waw := valid && waw_hazard
+  io.perf.war := valid && war_hazard
   io.head := head
   io.tail := tail
 }
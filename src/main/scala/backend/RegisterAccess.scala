@@ -36,6 +36,8 @@ class RegisterAccess(exSeqs: Int, maxExuDepth: Int)(implicit p: Parameters) exte
     val pipe_writes = Vec(exSeqs, Input(Valid(new VectorWrite(dLen))))
     val iter_writes = Vec(exSeqs, Flipped(Decoupled(new VectorWrite(dLen))))
     val load_write = Flipped(Decoupled(new VectorWrite(dLen)))
+
+    val read_conflict = Output(Bool())
   })
 
   // 3R1W banks
@@ -45,6 +47,9 @@ class RegisterAccess(exSeqs: Int, maxExuDepth: Int)(implicit p: Parameters) exte
 
   // Mask read arbitrates between <- [vxs], vls, vss, vps, frontend-mask
 
+  // With vrfSRAM, the three read ports return data the cycle after the
+  // request fires. Mask reads are always answered in the same cycle.
+
   val vrf = Module(new RegisterFile(
     reads = Seq(1 + exSeqs, 1 + exSeqs, 1 + exSeqs),
     maskReads = Seq(4 + exSeqs),
@@ -89,6 +94,8 @@ class RegisterAccess(exSeqs: Int, maxExuDepth: Int)(implicit p: Parameters) exte
   vrf.io.mask_read(0)(exSeqs+2) <> io.vps.rvm
   vrf.io.mask_read(0)(exSeqs+3) <> io.frontend.rmask
 
+  io.read_conflict := vrf.io.read_conflict
+
   when (resetting) {
     io.vls.rvm.req.ready := false.B
     io.vss.rvd.req.ready := false.B
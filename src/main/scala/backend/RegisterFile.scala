@@ -23,10 +23,11 @@ class OldestRRArbiter(val n: Int)(implicit p: Parameters) extends Module {
   }
 }
 
-class RegisterReadXbar(n: Int, banks: Int)(implicit p: Parameters) extends CoreModule()(p) with HasVectorParams {
+class RegisterReadXbar(n: Int, banks: Int, lateResp: Boolean = false)(implicit p: Parameters) extends CoreModule()(p) with HasVectorParams {
   val io = IO(new Bundle {
     val in = Vec(n, Flipped(new VectorReadIO))
     val out = Vec(banks, new VectorReadIO)
+    val conflict = Output(Bool()) // more than one request for some bank
   })
 
   val arbs = Seq.fill(banks) { Module(new OldestRRArbiter(n)) }
@@ -35,6 +36,7 @@ class RegisterReadXbar(n: Int, banks: Int)(implicit p: Parameters) extends CoreM
   }
 
   val bankOffset = log2Ceil(banks)
+  io.conflict := arbs.map(a => PopCount(a.io.in.map(_.valid)) > 1.U).orR
 
   for (i <- 0 until n) {
     val bank_sel = if (bankOffset == 0) true.B else UIntToOH(io.in(i).req.bits.eg(bankOffset-1,0))
@@ -44,7 +46,37 @@ class RegisterReadXbar(n: Int, banks: Int)(implicit p: Parameters) extends CoreM
       arbs(j).io.in(i).bits.oldest := io.in(i).req.bits.oldest
     }
     io.in(i).req.ready := Mux1H(bank_sel, arbs.map(_.io.in(i).ready))
-    io.in(i).resp := Mux1H(bank_sel, io.out.map(_.resp))
+    // SRAM banks answer the cycle after the request
+    val resp_sel = if (lateResp) RegNext(bank_sel) else bank_sel
+    io.in(i).resp := Mux1H(resp_sel, io.out.map(_.resp))
+  }
+}
+
+// SRAM-backed bank storage, built from dLen/64 lane macros with a registered
+// read. Each read port has its own copy of the lanes, so every macro has a
+// single read port, and writes go to all copies. Read data returns the cycle
+// after the request fires.
+class RegisterFileSRAM(reads: Int, rows: Int)(implicit p: Parameters) extends CoreModule()(p) with HasVectorParams {
+  val io = IO(new Bundle {
+    val read = Vec(reads, Flipped(new VectorReadIO))
+    val write = Input(Valid(new VectorWrite(dLen)))
+  })
+
+  val nLanes = dLen / 64
+  def row(eg: UInt) = if (rows == 1) 0.U else eg(log2Ceil(rows)-1,0)
+
+  for (read <- io.read) {
+    val lanes = Seq.fill(nLanes) { SyncReadMem(rows, Vec(64, Bool()), SyncReadMem.ReadFirst) }
+    when (io.write.valid) {
+      lanes.zipWithIndex.foreach { case (lane, l) =>
+        lane.write(
+          row(io.write.bits.eg),
+          VecInit(io.write.bits.data(l*64+63,l*64).asBools),
+          io.write.bits.mask(l*64+63,l*64).asBools)
+      }
+    }
+    read.req.ready := true.B
+    read.resp := VecInit(lanes.map(_.read(row(read.req.bits.eg), read.req.valid).asUInt)).asUInt
   }
 }
 
@@ -58,15 +90,38 @@ class RegisterFileBank(reads: Int, maskReads: Int, rows: Int, maskRows: Int)(imp
   val ll_write_valid = RegInit(false.B)
   val ll_write_bits = Reg(new VectorWrite(dLen))
 
-  val vrf = Mem(rows, Vec(dLen, Bool()))
-  val v0_mask = Mem(maskRows, Vec(dLen, Bool()))
-  for (read <- io.read) {
-    read.req.ready := !(ll_write_valid && read.req.bits.eg === ll_write_bits.eg)
-    read.resp := DontCare
-    when (read.req.valid) {
-      read.resp := vrf.read(read.req.bits.eg).asUInt
+  val write = WireInit(io.write)
+
+  if (vParams.vrfSRAM) {
+    val vrf = Module(new RegisterFileSRAM(reads, rows))
+    for ((read, port) <- io.read.zip(vrf.io.read)) {
+      val ll_block = ll_write_valid && read.req.bits.eg === ll_write_bits.eg
+      port.req.valid := read.req.valid && !ll_block
+      port.req.bits := read.req.bits
+      read.req.ready := port.req.ready && !ll_block
+      read.resp := port.resp
+    }
+    vrf.io.write := write
+  } else {
+    val vrf = Mem(rows, Vec(dLen, Bool()))
+    for (read <- io.read) {
+      read.req.ready := !(ll_write_valid && read.req.bits.eg === ll_write_bits.eg)
+      read.resp := DontCare
+      when (read.req.valid) {
+        read.resp := vrf.read(read.req.bits.eg).asUInt
+      }
+    }
+    when (write.valid) {
+      vrf.write(
+        write.bits.eg,
+        VecInit(write.bits.data.asBools),
+        write.bits.mask.asBools)
     }
   }
+
+  // The v0 copy stays in flops even with SRAM banks, so mask reads are
+  // always answered in the same cycle
+  val v0_mask = Mem(maskRows, Vec(dLen, Bool()))
   for (mask_read <- io.mask_read) {
     mask_read.req.ready := !(ll_write_valid && mask_read.req.bits.eg === ll_write_bits.eg)
     mask_read.resp := DontCare
@@ -74,8 +129,13 @@ class RegisterFileBank(reads: Int, maskReads: Int, rows: Int, maskRows: Int)(imp
       mask_read.resp := v0_mask.read(mask_read.req.bits.eg).asUInt
     }
   }
+  when (write.valid && write.bits.eg < maskRows.U) {
+    v0_mask.write(
+      write.bits.eg,
+      VecInit(write.bits.data.asBools),
+      write.bits.mask.asBools)
+  }
 
-  val write = WireInit(io.write)
   io.ll_write.ready := false.B
   if (vParams.vrfHiccupBuffer) {
     when (!io.write.valid) { // drain hiccup buffer
@@ -101,19 +161,6 @@ class RegisterFileBank(reads: Int, maskReads: Int, rows: Int, maskRows: Int)(imp
       write.bits := io.ll_write.bits
     }
   }
-
-  when (write.valid) {
-    vrf.write(
-      write.bits.eg,
-      VecInit(write.bits.data.asBools),
-      write.bits.mask.asBools)
-    when (write.bits.eg < maskRows.U) {
-      v0_mask.write(
-        write.bits.eg,
-        VecInit(write.bits.data.asBools),
-        write.bits.mask.asBools)
-    }
-  }
 }
 
 class RegisterFile(reads: Seq[Int], maskReads: Seq[Int], pipeWrites: Int, llWrites: Int, maxDepth: Int)(implicit p: Parameters) extends CoreModule()(p) with HasVectorParams {
@@ -129,25 +176,45 @@ class RegisterFile(reads: Seq[Int], maskReads: Seq[Int], pipeWrites: Int, llWrit
 
     val pipe_writes = Vec(pipeWrites, Input(Valid(new VectorWrite(dLen))))
     val ll_writes = Vec(llWrites, Flipped(Decoupled(new VectorWrite(dLen))))
+
+    val read_conflict = Output(Bool())
   })
 
   val vrf = Seq.fill(nBanks) { Module(new RegisterFileBank(reads.size, maskReads.size, egsTotal/nBanks, if (egsPerVReg < nBanks) 1 else egsPerVReg / nBanks)) }
 
-  reads.zipWithIndex.foreach { case (rc, i) =>
-    val xbar = Module(new RegisterReadXbar(rc, nBanks))
+  // Merge the pipe writes landing this cycle into reads of the same eg, so
+  // a chained read need not wait for the write to reach the bank. A read
+  // the write fully covers skips bank arbitration.
+  def bypass(read: VectorReadIO, port: VectorReadIO): Unit = if (vParams.vrfBypass) {
+    val hits = io.pipe_writes.map(w => w.valid && w.bits.eg === read.req.bits.eg)
+    val covered = hits.zip(io.pipe_writes).map { case (h, w) => h && w.bits.mask.andR }.orR
+    port.req.valid := read.req.valid && !covered
+    read.req.ready := port.req.ready || covered
+    read.resp := hits.zip(io.pipe_writes).foldLeft(port.resp) { case (data, (h, w)) =>
+      Mux(h, (data & ~w.bits.mask) | (w.bits.data & w.bits.mask), data)
+    }
+  }
+
+  val xbars = reads.zipWithIndex.map { case (rc, i) =>
+    val xbar = Module(new RegisterReadXbar(rc, nBanks, vParams.vrfSRAM))
     vrf.zipWithIndex.foreach { case (bank, j) =>
       bank.io.read(i) <> xbar.io.out(j)
     }
     xbar.io.in <> io.read(i)
+    io.read(i).zip(xbar.io.in).foreach { case (r, x) => bypass(r, x) }
+    xbar
   }
 
-  maskReads.zipWithIndex.foreach { case (rc, i) =>
+  val mask_xbars = maskReads.zipWithIndex.map { case (rc, i) =>
     val mask_xbar = Module(new RegisterReadXbar(rc, nBanks))
     vrf.zipWithIndex.foreach { case (bank, j) =>
       bank.io.mask_read(i) <> mask_xbar.io.out(j)
     }
     mask_xbar.io.in <> io.mask_read(i)
+    io.mask_read(i).zip(mask_xbar.io.in).foreach { case (r, x) => bypass(r, x) }
+    mask_xbar
   }
+  io.read_conflict := (xbars ++ mask_xbars).map(_.io.conflict).orR
 
   io.ll_writes.foreach(_.ready := false.B)
 
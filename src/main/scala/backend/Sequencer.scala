@@ -15,15 +15,16 @@ class SequencerIO[T <: Data](issType: T)(implicit p: Parameters) extends CoreBun
   val seq_hazard = Output(Valid(new SequencerHazard))
   val vat = Output(UInt(vParams.vatSz.W))
 
-  // Consumes older reads/writes
-  val older_writes = Input(UInt(egsTotal.W))
-  val older_reads  = Input(UInt(egsTotal.W))
+  // Checks the next issue against older reads/writes
+  val hazard_query = Output(new HazardQuery)
+  val hazards = Input(new DataHazards)
 
   // Used to determine when this is the oldest insn
   val vat_head = Input(UInt(vParams.vatSz.W))
 
   val busy = Output(Bool())
   val head = Output(Bool())
+  val perf = Output(new SequencerPerf)
 
   // Issued operation
   val iss = Decoupled(issType)
@@ -35,6 +36,75 @@ abstract class Sequencer[T <: Data](implicit p: Parameters) extends CoreModule()
 
   def accepts(inst: VectorIssueInst): Bool
 
+  // Element groups of one operand that are yet to be accessed. With
+  // intervalHazards this is a progress pointer and the last eg of the
+  // operand's registers. The pointer only advances past the eg it points
+  // at, so an out-of-order clear leaves a conservative range.
+  class EgIntent(width: Int = egsTotal) {
+    val mask  = Option.when(!vParams.intervalHazards)(Reg(UInt(width.W)))
+    val valid = Option.when(vParams.intervalHazards)(Reg(Bool()))
+    val lo    = Option.when(vParams.intervalHazards)(Reg(UInt(log2Ceil(egsTotal).W)))
+    val hi    = Option.when(vParams.intervalHazards)(Reg(UInt(log2Ceil(egsTotal).W)))
+
+    // Covers vregs first through last, in the copies selected by home
+    def set(en: Bool, first: UInt, last: UInt, home: UInt) = {
+      val arch_mask = VecInit.tabulate(32)(r => r.U >= first && r.U <= last).asUInt
+      mask.foreach(_ := Mux(en, FillInterleaved(egsPerVReg, physVRegs(arch_mask, home)), 0.U))
+      valid.foreach(_ := en)
+      lo.foreach(_ := first << log2Ceil(egsPerVReg))
+      hi.foreach(_ := (((last +& 1.U) << log2Ceil(egsPerVReg)) - 1.U)(log2Ceil(egsTotal)-1,0))
+    }
+    def clear(eg: UInt) = {
+      mask.foreach(m => m := m & ~UIntToOH(eg))
+      valid.foreach { v =>
+        when (eg === lo.get) {
+          lo.get := lo.get + 1.U
+          when (lo.get === hi.get) { v := false.B }
+        }
+      }
+    }
+    def clearAll() = {
+      mask.foreach(_ := 0.U)
+      valid.foreach(_ := false.B)
+    }
+    def interval = {
+      val i = Wire(Valid(new EgInterval))
+      i.valid := valid.get
+      i.bits.lo := lo.get
+      i.bits.hi := hi.get
+      i
+    }
+  }
+
+  // Mask reads only cover v0, which may be in either copy with vrfRenaming
+  def maskIntent() = new EgIntent(if (vParams.vrfRenaming) egsTotal else egsPerVReg)
+
+  def vregGroup(reg: UInt, lmul: UInt): (UInt, UInt) = {
+    val first = ((reg >> lmul) << lmul)(4,0)
+    (first, (first | ((1.U << lmul) - 1.U))(4,0))
+  }
+
+  def intents(n: Int, ts: EgIntent*): EgIntents = {
+    val w = Wire(new EgIntents(n))
+    w.mask.foreach(_ := hazardMultiply(ts.map(_.mask.get).foldLeft(0.U)(_|_)))
+    w.intervals.foreach { ivs =>
+      ivs.foreach { i => i.valid := false.B; i.bits := DontCare }
+      ts.zip(ivs).foreach { case (t, i) => i := t.interval }
+    }
+    w
+  }
+
+  def checkHazards(reads: Seq[(Bool, UInt)], write: (Bool, UInt)): DataHazards = {
+    io.hazard_query.reads.foreach { r => r.valid := false.B; r.bits := DontCare }
+    reads.zip(io.hazard_query.reads).foreach { case ((en, eg), r) =>
+      r.valid := en
+      r.bits := eg
+    }
+    io.hazard_query.write.valid := write._1
+    io.hazard_query.write.bits := write._2
+    io.hazards
+  }
+
   def get_head_mask(bit_mask: UInt, eidx: UInt, eew: UInt, len: Int) = {
     val lenOffBits = log2Ceil(len / 8)
     bit_mask << (eidx << eew)(lenOffBits-1,0)
@@ -22,7 +22,7 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
     val needs_mask = inst.vmu && (!inst.vm && inst.mop =/= mopUnit)
     val needs_index = inst.vmu && inst.mop(0)
     val ctrl = new VectorDecoder(inst, exu_insns, Seq(UsesGatherUnit, Reduction))
-    val gather = !inst.vmu && ctrl.bool(UsesGatherUnit)
+    val gather = !inst.vmu && ctrl.bool(UsesGatherUnit) && !inst.xbar_gather
     val reduction = !inst.vmu && ctrl.bool(Reduction)
     needs_mask || needs_index || gather || reduction
   }
@@ -33,8 +33,8 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
   val acc = Reg(Bool())
   val inst  = Reg(new BackendIssueInst)
   val eidx  = Reg(UInt(log2Ceil(maxVLMax).W))
-  val rvs2_mask = Reg(UInt(egsTotal.W))
-  val rvm_mask = Reg(UInt(egsPerVReg.W))
+  val rvs2_mask = new EgIntent
+  val rvm_mask = maskIntent()
   val head = Reg(Bool())
   val slide_offset = Reg(UInt((1+log2Ceil(maxVLMax)).W))
   val acc_e0 = Reg(Bool())
@@ -78,15 +78,15 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
       dis_inst.vconfig.vl <= offset,
       offset >= vlmax)
     val rs2 = Mux(dis_inst.rs1_is_rs2, dis_inst.rs1, dis_inst.rs2)
-    val renv2_arch_mask = get_arch_mask(rs2, dis_inst.emul)
+    val (vs2_first, vs2_last) = vregGroup(rs2, dis_inst.emul)
 
     valid := Mux(!slide, true.B, !slide_no_read)
     inst  := dis_inst
     eidx  := Mux(!slide, dis_inst.vstart, slide_start)
     slide_offset := offset
 
-    rvs2_mask := Mux(dis_inst.renv2, FillInterleaved(egsPerVReg, renv2_arch_mask), 0.U)
-    rvm_mask := Mux(dis_inst.renvm, ~(0.U(egsPerVReg.W)), 0.U)
+    rvs2_mask.set(dis_inst.renv2, vs2_first, vs2_last, dis_inst.rhome)
+    rvm_mask.set(dis_inst.renvm, 0.U, 0.U, dis_inst.rhome)
     head := true.B
 
     val dis_vd_eew = dis_inst.vconfig.vtype.vsew + dis_inst.wide_vd
@@ -118,33 +118,49 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
 
   io.vat := inst.vat
   io.seq_hazard.valid := valid && (!acc || acc_e0)
-  io.seq_hazard.bits.rintent := hazardMultiply(Mux(acc, get_arch_mask(inst.rs1, 0.U), rvs2_mask | rvm_mask))
-  io.seq_hazard.bits.wintent := false.B
+  val acc_eg = physEg(getEgId(inst.rs1, 0.U, vd_eew, false.B), inst.rhome)
+  val acc_rintent = Wire(new EgIntents(4))
+  acc_rintent.mask.foreach(_ := hazardMultiply(UIntToOH(acc_eg, egsTotal)))
+  acc_rintent.intervals.foreach { ivs =>
+    ivs.foreach { i => i.valid := false.B; i.bits := DontCare }
+    ivs(0).valid := true.B
+    ivs(0).bits.lo := acc_eg
+    ivs(0).bits.hi := acc_eg
+  }
+  io.seq_hazard.bits.rintent := Mux(acc, acc_rintent, intents(4, rvs2_mask, rvm_mask))
+  io.seq_hazard.bits.wintent := intents(1)
   io.seq_hazard.bits.vat := inst.vat
 
-  val vs2_read_oh = Mux(renv2, UIntToOH(io.rvs2.bits.eg), 0.U)
-  val vm_read_oh  = Mux(renvm, UIntToOH(io.rvm.bits.eg), 0.U)
-
-  val raw_hazard = ((vm_read_oh | vs2_read_oh) & io.older_writes) =/= 0.U
+  val raw_hazard = checkHazards(Seq((renv2, io.rvs2.bits.eg), (renvm, io.rvm.bits.eg)), (false.B, 0.U)).raw
   val data_hazard = raw_hazard
 
   val oldest = inst.vat === io.vat_head
 
-  io.rvs2.valid := valid && renv2
+  // SRAM VRF banks return rvs2 the cycle after the read, so the op holds
+  // at issue for that cycle
+  val rvs2_returned = RegNext(io.rvs2.fire && !raw_hazard && vParams.vrfSRAM.B, false.B)
+  val rvs2_ready = if (vParams.vrfSRAM) rvs2_returned else io.rvs2.ready
+
+  io.rvs2.valid := valid && renv2 && !rvs2_returned
   io.rvs2.bits.eg := Mux(acc,
-    getEgId(inst.rs1, 0.U, vd_eew, false.B),
-    getEgId(rs2, eidx, incr_eew, false.B)
+    acc_eg,
+    physEg(getEgId(rs2, eidx, incr_eew, false.B), inst.rhome)
   )
   io.rvs2.bits.oldest := oldest
 
   io.rvm.valid := valid && renvm
-  io.rvm.bits.eg := getEgId(0.U, eidx, 0.U, true.B)
+  io.rvm.bits.eg := physEg(getEgId(0.U, eidx, 0.U, true.B), inst.rhome)
   io.rvm.bits.oldest := oldest
 
   io.busy := valid
+  io.perf.busy := valid
+  io.perf.issue := io.iss.fire
+  io.perf.raw := valid && raw_hazard
+  io.perf.waw := false.B
+  io.perf.war := false.B
   io.head := Mux(acc, acc_e0, head)
 
-  io.iss.valid := valid && !data_hazard && (!renvm || io.rvm.ready) && (!renv2 || io.rvs2.ready) && !acc
+  io.iss.valid := valid && !data_hazard && (!renvm || io.rvm.ready) && (!renv2 || rvs2_ready) && !acc
   io.iss.bits.renv2     := renv2
   io.iss.bits.renvm     := renvm
   io.iss.bits.rvs2_eew  := incr_eew
@@ -165,7 +181,8 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
   ))
 
 
-  when (io.rvs2.fire && !raw_hazard) {
+  val acc_init_valid = if (vParams.vrfSRAM) rvs2_returned else io.rvs2.fire && !raw_hazard
+  when (acc_init_valid) {
     val v0_mask = eewByteMask(vd_eew)
     val init_resp = io.acc_init_resp.asTypeOf(Vec(dLenB, UInt(8.W)))
     for (i <- 0 until 8) {
@@ -194,10 +211,10 @@ class SpecialSequencer(exu_insns: Seq[VectorInstruction])(implicit p: Parameters
 
   when (io.iss.fire && !tail) {
     when (next_is_new_eg(eidx, next_eidx, incr_eew, false.B) && vParams.enableChaining.B) {
-      rvs2_mask := rvs2_mask & ~vs2_read_oh
+      when (renv2) { rvs2_mask.clear(io.rvs2.bits.eg) }
     }
     when (next_is_new_eg(eidx, next_eidx, 0.U, true.B) && vParams.enableChaining.B) {
-      rvm_mask := rvm_mask & ~UIntToOH(io.rvm.bits.eg)
+      rvm_mask.clear(io.rvm.bits.eg)
     }
     eidx := next_eidx
   }
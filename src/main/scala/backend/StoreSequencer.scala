@@ -19,8 +19,8 @@ class StoreSequencer(implicit p: Parameters) extends Sequencer[StoreDataMicroOp]
   val inst     = Reg(new VectorIssueInst)
   val eidx     = Reg(UInt(log2Ceil(maxVLMax).W))
   val sidx     = Reg(UInt(3.W))
-  val rvd_mask = Reg(UInt(egsTotal.W))
-  val rvm_mask = Reg(UInt(egsPerVReg.W))
+  val rvd_mask = new EgIntent
+  val rvm_mask = maskIntent()
   val sub_mlen = Reg(UInt(2.W))
   val head     = Reg(Bool())
 
@@ -37,14 +37,10 @@ class StoreSequencer(implicit p: Parameters) extends Sequencer[StoreDataMicroOp]
     eidx  := iss_inst.vstart
     sidx  := 0.U
 
-    val rvd_arch_mask = Wire(Vec(32, Bool()))
-    for (i <- 0 until 32) {
-      val group = i.U >> iss_inst.emul
-      val rd_group = iss_inst.rd >> iss_inst.emul
-      rvd_arch_mask(i) := group >= rd_group && group <= (rd_group + iss_inst.nf)
-    }
-    rvd_mask := FillInterleaved(egsPerVReg, rvd_arch_mask.asUInt)
-    rvm_mask := Mux(!iss_inst.vm, ~(0.U(egsPerVReg.W)), 0.U)
+    val rd_group = iss_inst.rd >> iss_inst.emul
+    val rvd_last = ((rd_group +& iss_inst.nf +& 1.U) << iss_inst.emul) - 1.U
+    rvd_mask.set(true.B, rd_group << iss_inst.emul, Mux(rvd_last > 31.U, 31.U, rvd_last), iss_inst.rhome)
+    rvm_mask.set(!iss_inst.vm, 0.U, 0.U, iss_inst.rhome)
     sub_mlen := Mux(iss_inst.seg_nf =/= 0.U && (mLenOffBits.U > (3.U +& iss_inst.mem_elem_size)),
       mLenOffBits.U - 3.U - iss_inst.mem_elem_size,
       0.U)
@@ -56,26 +52,29 @@ class StoreSequencer(implicit p: Parameters) extends Sequencer[StoreDataMicroOp]
 
   io.vat := inst.vat
   io.seq_hazard.valid := valid
-  io.seq_hazard.bits.rintent := hazardMultiply(rvd_mask | rvm_mask)
-  io.seq_hazard.bits.wintent := 0.U
+  io.seq_hazard.bits.rintent := intents(4, rvd_mask, rvm_mask)
+  io.seq_hazard.bits.wintent := intents(1)
   io.seq_hazard.bits.vat := inst.vat
 
-  val vd_read_oh = UIntToOH(io.rvd.bits.eg)
-  val vm_read_oh = Mux(renvm, UIntToOH(io.rvm.bits.eg), 0.U)
-
-  val raw_hazard = ((vm_read_oh | vd_read_oh) & io.older_writes) =/= 0.U
+  val hazards = checkHazards(Seq((true.B, io.rvd.bits.eg), (renvm, io.rvm.bits.eg)), (false.B, 0.U))
+  val raw_hazard = hazards.raw
   val data_hazard = raw_hazard
 
   val oldest = inst.vat === io.vat_head
 
-  io.rvd.valid := valid && io.iss.ready
-  io.rvd.bits.eg := getEgId(inst.rd + (sidx << inst.emul), eidx, inst.mem_elem_size, false.B)
+  // SRAM VRF banks return rvd the cycle after the read, so the op holds
+  // at issue for that cycle
+  val rvd_returned = RegNext(io.rvd.fire && !data_hazard && vParams.vrfSRAM.B, false.B)
+  val rvd_ready = if (vParams.vrfSRAM) rvd_returned else io.rvd.ready
+
+  io.rvd.valid := valid && io.iss.ready && !rvd_returned
+  io.rvd.bits.eg := physEg(getEgId(inst.rd + (sidx << inst.emul), eidx, inst.mem_elem_size, false.B), inst.rhome)
   io.rvd.bits.oldest := oldest
   io.rvm.valid := valid && renvm && io.iss.ready
-  io.rvm.bits.eg := getEgId(0.U, eidx, 0.U, true.B)
+  io.rvm.bits.eg := physEg(getEgId(0.U, eidx, 0.U, true.B), inst.rhome)
   io.rvm.bits.oldest := oldest
 
-  io.iss.valid := valid && !data_hazard && (!renvm || io.rvm.ready) && io.rvd.ready
+  io.iss.valid := valid && !data_hazard && (!renvm || io.rvm.ready) && rvd_ready
   io.iss.bits.use_stmask := renvm
   io.iss.bits.eidx := eidx
   io.iss.bits.elem_size := inst.mem_elem_size
@@ -90,10 +89,10 @@ class StoreSequencer(implicit p: Parameters) extends Sequencer[StoreDataMicroOp]
   when (io.iss.fire && !tail) {
     if (vParams.enableChaining) {
       when (next_is_new_eg(eidx, next_eidx, inst.mem_elem_size, false.B)) {
-        rvd_mask := rvd_mask & ~UIntToOH(io.rvd.bits.eg)
+        rvd_mask.clear(io.rvd.bits.eg)
       }
       when (next_is_new_eg(eidx, next_eidx, 0.U, true.B)) {
-        rvm_mask := rvm_mask & ~UIntToOH(io.rvm.bits.eg)
+        rvm_mask.clear(io.rvm.bits.eg)
       }
     }
     when (sidx === inst.seg_nf) {
@@ -105,5 +104,10 @@ class StoreSequencer(implicit p: Parameters) extends Sequencer[StoreDataMicroOp]
   }
 
   io.busy := valid
+  io.perf.busy := valid
+  io.perf.issue := io.iss.fire
+  io.perf.raw := valid && raw_hazard
+  io.perf.waw := false.B
+  io.perf.war := false.B
   io.head := head
 }
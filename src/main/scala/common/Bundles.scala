@@ -31,10 +31,13 @@ class VectorMemMacroOp(implicit p: Parameters) extends CoreBundle()(p) with HasV
   val whole_reg = Bool()
   val store = Bool()
   val fast_sg = Bool()
+  val stride_x0 = Bool() // rs2 is x0, so a zero stride need not repeat the access
 
   def indexed = !mop.isOneOf(mopUnit, mopStrided)
   def seg_nf = Mux(whole_reg, 0.U, nf)
   def wr_nf = Mux(whole_reg, nf, 0.U)
+  // Unit-stride ops of at least streamBytes bypass the L1, everything else uses it
+  def prefers_l1(streamBytes: Int) = (streamBytes > 0).B && (mop =/= mopUnit || (((nf +& 1.U) * vl) << elem_size) < streamBytes.U)
 }
 
 // Bundle between VDQ and Backend
@@ -56,6 +59,9 @@ class VectorIssueInst(implicit p: Parameters) extends CoreBundle()(p) with HasVe
   val fast_sg = Bool()
   val debug_id = UInt(debugIdSz.W)
   val mop = UInt(2.W) // stored separately from bits since dispatch may need to set this
+  // Physical copies of each vreg this reads from and writes to, set at dispatch
+  val rhome = UInt((if (vParams.vrfRenaming) 32 else 0).W)
+  val whome = UInt((if (vParams.vrfRenaming) 32 else 0).W)
 
   def opcode = bits(6,0)
   def store = opcode(5)
@@ -89,6 +95,11 @@ class VectorIssueInst(implicit p: Parameters) extends CoreBundle()(p) with HasVe
   def opmf6 = Mux(isOpm, OPMFunct6(funct6), OPMFunct6.illegal)
   def opif6 = Mux(isOpi, OPIFunct6(funct6), OPIFunct6.illegal)
   def opff6 = Mux(isOpf, OPFFunct6(funct6), OPFFunct6.illegal)
+
+  // vrgather.vv/vrgatherei16.vv with LMUL<=1 (and index EEW <= SEW) are
+  // gathered a whole element group at a time, bypassing the gather unit
+  def xbar_gather = !vmu && funct3 === OPIVV && emul === 0.U && (opif6 === OPIFunct6.rgather ||
+    (opif6 === OPIFunct6.rgatherei16 && sew =/= 0.U))
 }
 
 class BackendIssueInst(implicit p: Parameters) extends VectorIssueInst()(p) {
@@ -111,6 +122,25 @@ class BackendIssueInst(implicit p: Parameters) extends VectorIssueInst()(p) {
 
 class IssueQueueInst(nSeqs: Int)(implicit p: Parameters) extends BackendIssueInst()(p) {
   val seq = UInt(nSeqs.W)
+
+  def vd_arch_mask = {
+    val only_writes_vd0 = scalar_to_vd0 || reduction
+    get_arch_mask(rd, Mux(only_writes_vd0, 0.U, emul +& wide_vd +& nf_log2))
+  }
+
+  // Per physical vreg read and write intents of this entry
+  def rintent: UInt = {
+    val vs2 = Mux(rs1_is_rs2, rs1, rs2)
+    val vs1_lmul = Mux(reads_vs1_mask, 0.U, emul)
+    val vs2_lmul = Mux(reads_vs2_mask, 0.U, emul +& wide_vs2 +& nf_log2)
+    physVRegs(Seq(
+      (renv1, get_arch_mask(rs1, vs1_lmul)),
+      (renv2, get_arch_mask(vs2, vs2_lmul)),
+      (renvd, vd_arch_mask),
+      (renvm, 1.U)
+    ).map(t => Mux(t._1, t._2, 0.U)).reduce(_|_), rhome)
+  }
+  def wintent: UInt = physVRegs(Mux(wvd, vd_arch_mask, 0.U), whome)
 }
 
 class VectorPipeWriteReqIO(maxPipeDepth: Int)(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
@@ -123,7 +153,7 @@ class VectorPipeWriteReqIO(maxPipeDepth: Int)(implicit p: Parameters) extends Co
 }
 
 class VectorWrite(writeBits: Int)(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
-  val eg = UInt(log2Ceil(32 * vLen / writeBits).W)
+  val eg = UInt(log2Ceil(nPhysVRegs * vLen / writeBits).W)
   def bankId = if (vrfBankBits == 0) 0.U else eg(vrfBankBits-1,0)
   val data = UInt(writeBits.W)
   val mask = UInt(writeBits.W)
@@ -187,6 +217,8 @@ class ExecuteMicroOp(nFUs: Int)(implicit p: Parameters) extends CoreBundle()(p)
 
   val use_zero_rvs2 = Bool()
   val use_slide_rvs2 = Bool()
+  val xbar_gather = Bool()
+  val gather_eg = UInt((log2Ceil(egsPerVReg) max 1).W) // source element group of this pass
   def use_normal_rvs2 = !use_zero_rvs2 && !use_slide_rvs2
 
   val slide_data = UInt(dLen.W)
@@ -204,6 +236,7 @@ class ExecuteMicroOp(nFUs: Int)(implicit p: Parameters) extends CoreBundle()(p)
   val pipe_depth = UInt(3.W)
 
   val wvd_eg   = UInt(log2Ceil(egsTotal).W)
+  val whome    = UInt((if (vParams.vrfRenaming) 32 else 0).W) // for compress, which picks its own egs
 
   val funct3 = UInt(3.W)
   def isOpi = funct3.isOneOf(OPIVV, OPIVI, OPIVX)
@@ -246,6 +279,29 @@ class ExecuteMicroOpWithData(nFUs: Int)(implicit p: Parameters) extends ExecuteM
   val rvd_elem  = UInt(64.W)
 }
 
+// Operands that SRAM VRF banks return the cycle after issue. Each valid
+// field replaces its counterpart in the issued op.
+class ExecuteLateOperands(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val rvs1_data = Valid(UInt(dLen.W))
+  val rvs2_data = Valid(UInt(dLen.W))
+  val rvd_data  = Valid(UInt(dLen.W))
+
+  val rvs1_elem = Valid(UInt(64.W))
+  val rvs2_elem = Valid(UInt(64.W))
+  val rvd_elem  = Valid(UInt(64.W))
+
+  def merge[T <: ExecuteMicroOpWithData](op: T): T = {
+    val w = WireInit(op)
+    when (rvs1_data.valid) { w.rvs1_data := rvs1_data.bits }
+    when (rvs2_data.valid) { w.rvs2_data := rvs2_data.bits }
+    when (rvd_data.valid)  { w.rvd_data  := rvd_data.bits }
+    when (rvs1_elem.valid) { w.rvs1_elem := rvs1_elem.bits }
+    when (rvs2_elem.valid) { w.rvs2_elem := rvs2_elem.bits }
+    when (rvd_elem.valid)  { w.rvd_elem  := rvd_elem.bits }
+    w
+  }
+}
+
 class StoreDataMicroOp(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
   val use_stmask = Bool()
   val elem_size = UInt(2.W)
@@ -289,15 +345,100 @@ class PipeHazard(pipe_depth: Int)(implicit p: Parameters) extends CoreBundle()(p
   def eg_oh = UIntToOH(eg)
 }
 
+class EgInterval(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val lo = UInt(log2Ceil(egsTotal).W)
+  val hi = UInt(log2Ceil(egsTotal).W)
+  def contains(eg: UInt) = lo <= eg && eg <= hi
+}
+
+// Element groups a sequencer has yet to read or write, either as a bitmask,
+// or with intervalHazards as up to n ranges of element groups
+class EgIntents(n: Int)(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val mask = Option.when(!vParams.intervalHazards)(UInt(egsTotal.W))
+  val intervals = Option.when(vParams.intervalHazards)(Vec(n, Valid(new EgInterval)))
+  def contains(eg: UInt): Bool = mask.map(_(eg)).getOrElse(
+    intervals.get.map(i => i.valid && i.bits.contains(eg)).orR)
+  def touchesV0: Bool = mask.map { m =>
+    (0 until nPhysVRegs by 32).map(v => m((v+1)*egsPerVReg-1, v*egsPerVReg).orR).orR
+  }.getOrElse(
+    intervals.get.map(i => i.valid && i.bits.lo < egsPerVReg.U).orR)
+}
+
 class SequencerHazard(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
   val vat = UInt(vParams.vatSz.W)
-  val rintent = UInt(egsTotal.W)
-  val wintent = UInt(egsTotal.W)
+  val rintent = new EgIntents(4)
+  val wintent = new EgIntents(1)
+}
+
+// Element groups a sequencer's next issue reads and writes
+class HazardQuery(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val reads = Vec(4, Valid(UInt(log2Ceil(egsTotal).W)))
+  val write = Valid(UInt(log2Ceil(egsTotal).W))
+}
+
+class DataHazards extends Bundle {
+  val raw = Bool() // an older instruction still writes a queried read
+  val waw = Bool() // an older instruction still writes the queried write
+  val war = Bool() // an older instruction still reads the queried write
 }
 
 
 class InstructionHazard(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
   val vat = UInt(vParams.vatSz.W)
-  val rintent = UInt(32.W)
-  val wintent = UInt(32.W)
+  val rintent = UInt(nPhysVRegs.W)
+  val wintent = UInt(nPhysVRegs.W)
+}
+
+// Per-cycle performance events. All are single bits except the load and
+// store byte counts
+class SequencerPerf extends Bundle {
+  val busy = Bool()  // holds an instruction
+  val issue = Bool() // issued an element group
+  val raw = Bool()   // stalled by an older write to a source
+  val waw = Bool()   // stalled by an older write to the destination
+  val war = Bool()   // stalled by an older read of the destination
+  def events(name: String) = Seq(
+    s"$name busy" -> busy, s"$name issue" -> issue,
+    s"$name raw stall" -> raw, s"$name waw stall" -> waw, s"$name war stall" -> war)
+}
+
+class VectorBackendPerf(nSeqs: Int) extends Bundle {
+  val issq_stall = Bool()        // dispatch blocked on a full issue queue
+  val vrf_read_conflict = Bool() // VRF read requests lost bank arbitration
+  val opu_macc = Bool()
+  val seqs = Vec(nSeqs, new SequencerPerf)
+}
+
+class VectorMemPerf(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val load_order_block = Bool()  // load address generation waits on an older store
+  val store_order_block = Bool() // store address generation waits on an older load
+  val load_replay = Bool()       // LIFQ replays a response that found the ROB full
+  val load_bytes = UInt(log2Ceil(mLenB+1).W)  // bytes of the op a load request carries
+  val store_bytes = UInt(log2Ceil(mLenB+1).W) // bytes a store request writes
+  val load_coalesced = Bool()    // strided/indexed load element served by the previous request
+  val load_forwarded = Bool()    // load request served from the store data buffer
+  val prefetch_useful = Bool()   // demand load reached a line the prefetcher had already fetched
+  val prefetch_late = Bool()     // demand load reached a line whose prefetch was still in flight
+  val prefetch_useless = Bool()  // prefetched line was replaced before any demand load reached it
+}
+
+// Fixed events first, then five per sequencer in VectorBackend's allSeqs order
+object VectorPerfEvents {
+  def apply(backend: VectorBackendPerf, mem: VectorMemPerf, seqNames: Seq[String]): Seq[(String, UInt)] = {
+    Seq(
+      "issue queue stall" -> backend.issq_stall,
+      "vrf read conflict" -> backend.vrf_read_conflict,
+      "opu macc" -> backend.opu_macc,
+      "load order block" -> mem.load_order_block,
+      "store order block" -> mem.store_order_block,
+      "load replay" -> mem.load_replay,
+      "load bytes" -> mem.load_bytes,
+      "store bytes" -> mem.store_bytes,
+      "load coalesced" -> mem.load_coalesced,
+      "load forwarded" -> mem.load_forwarded,
+      "prefetch useful" -> mem.prefetch_useful,
+      "prefetch late" -> mem.prefetch_late,
+      "prefetch useless" -> mem.prefetch_useless
+    ) ++ backend.seqs.zip(seqNames).map { case (s, n) => s.events(n) }.flatten
+  }
 }
@@ -60,7 +60,7 @@ object OPMFunct6 extends ChiselEnum {
   val nmsac = Value
 
   val waddu, wadd, wsubu, wsub, wadduw, waddw, wsubuw, wsubw, wmulu = Value
-  val _ = Value
+  val opmacci = Value
   val wmulsu, wmul, wmaccu, wmacc, wmaccus, wmaccsu = Value
 
   val illegal = Value(0x40.U)
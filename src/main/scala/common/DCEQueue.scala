@@ -13,12 +13,16 @@ class DCEQueue[T <: Data](
   val gen:            T,
   val entries:        Int,
   val pipe:           Boolean = false,
-  val flow:           Boolean = false)(implicit val p: Parameters) extends Module {
+  val flow:           Boolean = false,
+  val dualDeq:        Boolean = false)(implicit val p: Parameters) extends Module {
   require(entries > -1, "Queue must have non-negative number of entries")
   require(entries != 0, "Use companion object Queue.apply for zero entries")
+  require(!dualDeq || (entries > 1 && !flow))
 
   val io = IO(new QueueIO(gen, entries, false) {
     val peek = Output(Vec(entries, Valid(gen)))
+    // The entry behind the head, which can only dequeue alongside it
+    val deq_second = Option.when(dualDeq)(Decoupled(gen))
   })
   val valids = RegInit(VecInit.fill(entries)(false.B))
   val ram = Reg(Vec(entries, gen))
@@ -30,6 +34,8 @@ class DCEQueue[T <: Data](
   val full = ptr_match && maybe_full
   val do_enq = WireDefault(io.enq.fire)
   val do_deq = WireDefault(io.deq.fire)
+  val deq_second_ptr = WrapInc(deq_ptr.value, entries)
+  val do_deq_second = io.deq_second.map(_.fire).getOrElse(false.B)
 
   for (i <- 0 until entries) {
     io.peek(i).bits := ram(i)
@@ -47,15 +53,29 @@ class DCEQueue[T <: Data](
     enq_ptr.inc()
   }
 
+  when(do_deq_second) {
+    deq_ptr.value := WrapInc(deq_second_ptr, entries)
+    valids(deq_second_ptr) := false.B
+  }
+
   when(do_enq =/= do_deq) {
     maybe_full := do_enq
   }
+  when(do_deq_second) {
+    maybe_full := false.B
+  }
 
   io.deq.valid := !empty
   io.enq.ready := !full
 
   io.deq.bits := ram(deq_ptr.value)
 
+  io.deq_second.foreach { d =>
+    d.valid := valids(deq_second_ptr)
+    d.bits := ram(deq_second_ptr)
+    assert(!d.fire || do_deq)
+  }
+
   if (flow) {
     when(io.enq.valid) { io.deq.valid := true.B }
     when(empty) {
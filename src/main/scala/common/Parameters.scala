@@ -56,6 +56,7 @@ object VectorParams {
     vliqEntries = 8, // beef this up since OPU tends to be used with LMUL=1
     vlissqEntries = 6,
     useOpu = true,
+    opuParams = OPUParameters(nMrfRegs = 4), // keep more C tiles resident across the K loop
     useElementwiseFP64 = false,
     useMxFPFMA = true,
     useMxConversion = true
@@ -151,29 +152,33 @@ object VXFunctionalUnitGroups {
     MaskUnitFactory(2),
     BitmanipPipeFactory
   )
-  def integerFUs(idivDoesImul: Boolean = false) = integerALUs ++ Seq(
-    IntegerDivideFactory(idivDoesImul),
+  def integerFUs(idivDoesImul: Boolean = false, simdDiv: Boolean = false) = integerALUs ++ Seq(
+    IntegerDivideFactory(idivDoesImul, simdDiv),
     PermuteUnitFactory,
-  )
+  ) ++ (if (simdDiv) Seq(SIMDIntegerDivideFactory) else Nil)
   def integerMAC(pipeDepth: Int, useSegmented: Boolean) = Seq(
     IntegerMultiplyFactory(pipeDepth, useSegmented)
   )
 
-  def sharedFPFMA(pipeDepth: Int) = Seq(
-    SharedScalarFPFMAFactory(pipeDepth)
+  def sharedFPFMA(pipeDepth: Int, treeReduction: Boolean = false) = Seq(
+    SharedScalarFPFMAFactory(pipeDepth, treeReduction)
+  )
+  def fpFMA(pipeDepth: Int, elementwiseFP64: Boolean, useMxFPFMA: Boolean, treeReduction: Boolean = false) = Seq(
+    SIMDFPFMAFactory(pipeDepth, elementwiseFP64, useMxFPFMA, treeReduction)
   )
-  def fpFMA(pipeDepth: Int, elementwiseFP64: Boolean, useMxFPFMA: Boolean) = Seq(
-    SIMDFPFMAFactory(pipeDepth, elementwiseFP64, useMxFPFMA)
+  def fpReduceTree(dLen: Int) = Seq(
+    FPReduceTreeFactory(dLen)
   )
-  def fpMisc(useMxConversion: Boolean) = Seq(
-    FPDivSqrtFactory,
+  def fpMisc(useMxConversion: Boolean, useSIMDFPDivSqrt: Boolean) = Seq(
+    FPDivSqrtFactory(!useSIMDFPDivSqrt),
     FPCmpFactory,
     FPConvFactory(useMxConversion)
-  )
+  ) ++ (if (useSIMDFPDivSqrt) Seq(SIMDFPDivSqrtFactory) else Nil)
 
-  def allFPFUs(fmaPipeDepth: Int, useScalarFPFMA: Boolean, elementwiseFP64: Boolean, useMxFPFMA: Boolean, useMxConversion: Boolean) = (
-    (if (useScalarFPFMA) sharedFPFMA(fmaPipeDepth) else fpFMA(fmaPipeDepth, elementwiseFP64, useMxFPFMA)) ++
-    fpMisc(useMxConversion)
+  def allFPFUs(fmaPipeDepth: Int, useScalarFPFMA: Boolean, elementwiseFP64: Boolean, useMxFPFMA: Boolean, useMxConversion: Boolean, useSIMDFPDivSqrt: Boolean, useFPReduceTree: Boolean, dLen: Int) = (
+    (if (useScalarFPFMA) sharedFPFMA(fmaPipeDepth, useFPReduceTree) else fpFMA(fmaPipeDepth, elementwiseFP64, useMxFPFMA, useFPReduceTree)) ++
+    fpMisc(useMxConversion, useSIMDFPDivSqrt) ++
+    (if (useFPReduceTree) fpReduceTree(dLen) else Nil)
   )
 }
 
@@ -191,9 +196,9 @@ object VectorIssueStructure {
         depth = params.vxissqEntries,
         seqs = Seq(
           VXSequencerParams("fp_int", (
-            integerFUs(params.useIterativeIMul) ++
+            integerFUs(params.useIterativeIMul, params.useSIMDIntegerDivide) ++
             (if (params.useIterativeIMul) Nil else integerMAC(params.imaPipeDepth, params.useSegmentedIMul)) ++
-            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion)
+            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen)
           ))
         )
       )
@@ -207,9 +212,9 @@ object VectorIssueStructure {
         name = "fp_int",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("int", integerFUs(params.useIterativeIMul)),
+          VXSequencerParams("int", integerFUs(params.useIterativeIMul, params.useSIMDIntegerDivide)),
           VXSequencerParams("fp",
-            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion) ++
+            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen) ++
             (if (params.useIterativeIMul) Nil else integerMAC(params.imaPipeDepth, params.useSegmentedIMul))
           )
         )
@@ -224,7 +229,7 @@ object VectorIssueStructure {
         name = "int",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("int", integerFUs(params.useIterativeIMul))
+          VXSequencerParams("int", integerFUs(params.useIterativeIMul, params.useSIMDIntegerDivide))
         )
       )
       val fp_path = VXIssuePathParams(
@@ -232,7 +237,7 @@ object VectorIssueStructure {
         depth = params.vxissqEntries,
         seqs = Seq(
           VXSequencerParams("fp",
-            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion) ++
+            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen) ++
             (if (params.useIterativeIMul) Nil else integerMAC(params.imaPipeDepth, params.useSegmentedIMul))
           )
         )
@@ -248,7 +253,7 @@ object VectorIssueStructure {
         name = "int",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("int", integerFUs(params.useIterativeIMul))
+          VXSequencerParams("int", integerFUs(params.useIterativeIMul, params.useSIMDIntegerDivide))
         )
       )
       val fp_path = VXIssuePathParams(
@@ -256,7 +261,7 @@ object VectorIssueStructure {
         depth = params.vxissqEntries,
         seqs = Seq(
           VXSequencerParams("fp0",
-            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion) ++
+            allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen) ++
             (if (params.useIterativeIMul) Nil else integerMAC(params.imaPipeDepth, params.useSegmentedIMul))
           ),
           VXSequencerParams("fp1", fpFMA(params.fmaPipeDepth, params.useElementwiseFP64, params.useMxFPFMA))
@@ -273,7 +278,7 @@ object VectorIssueStructure {
         name = "int",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("int0", integerFUs(false) ++ integerMAC(params.imaPipeDepth, true)),
+          VXSequencerParams("int0", integerFUs(false, params.useSIMDIntegerDivide) ++ integerMAC(params.imaPipeDepth, true)),
           VXSequencerParams("int1", integerALUs)
         )
       )
@@ -281,7 +286,7 @@ object VectorIssueStructure {
         name = "fp",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("fp", allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion))
+          VXSequencerParams("fp", allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen))
         )
       )
       Seq(int_path, fp_path)
@@ -295,7 +300,7 @@ object VectorIssueStructure {
         name = "int",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("int0", integerFUs(false) ++ integerMAC(params.imaPipeDepth, true)),
+          VXSequencerParams("int0", integerFUs(false, params.useSIMDIntegerDivide) ++ integerMAC(params.imaPipeDepth, true)),
           VXSequencerParams("int1", integerALUs ++ integerMAC(params.imaPipeDepth, true))
         )
       )
@@ -303,7 +308,7 @@ object VectorIssueStructure {
         name = "fp",
         depth = params.vxissqEntries,
         seqs = Seq(
-          VXSequencerParams("fp", allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion))
+          VXSequencerParams("fp", allFPFUs(params.fmaPipeDepth, params.useScalarFPFMA, params.useElementwiseFP64, params.useMxFPFMA, params.useMxConversion, params.useSIMDFPDivSqrt, params.useFPReduceTree, params.dLen))
         )
       )
       Seq(int_path, fp_path)
@@ -343,6 +348,9 @@ case class VectorParams(
   useScalarFPFMA: Boolean = true,       // Use shared scalar FPU all non-FMA FP instructions
   useIterativeIMul: Boolean = false,
   useElementwiseFP64: Boolean = false,
+  useSIMDFPDivSqrt: Boolean = false,    // Pipelined divide/sqrt of a whole element group per cycle, on one array shared by all formats
+  useSIMDIntegerDivide: Boolean = false, // Same for e8/e16/e32 integer divide/remainder
+  useFPReduceTree: Boolean = false,     // Adder tree for unordered FP32/FP64 sum reductions
   fmaPipeDepth: Int = 4,
   imaPipeDepth: Int = 4,
 
@@ -357,13 +365,23 @@ case class VectorParams(
   latencyInject: Boolean = false,
   enableDAE: Boolean = true,
   enableOOO: Boolean = true,
+  dualDispatch: Boolean = false, // dispatch up to two VDQ entries per cycle to disjoint issue queues
   enableScalarVectorAddrDisambiguation: Boolean = true,
+  forwardStores: Boolean = false, // unit-stride loads forward from unacknowledged vector stores
+  prefetchLines: Int = 0,        // lines the stream prefetcher runs ahead of unit-stride loads, 0 disables it
+  streamingStores: Boolean = false, // write-combine stores into full lines on TL, don't allocate them in the L1
+  l1StreamBytes: Int = 0,        // with an L1 port, shorter unit-stride and all strided/indexed ops use it, 0 disables
 
   doubleBufferSegments: Boolean = false,
   bufferStdata: Boolean = false, // adds a buffer between the backend and store segmenter
+  coalesceLoads: Boolean = false, // strided/indexed loads share requests to the same mLenB block
 
   vrfBanking: Int = 2,
   vrfHiccupBuffer: Boolean = true,
+  vrfSRAM: Boolean = false,      // build VRF banks from registered-read 64b lane SRAMs
+  intervalHazards: Boolean = false, // track pending accesses as eg ranges instead of egsTotal-wide masks
+  vrfRenaming: Boolean = false,  // keep two physical copies of each vreg, renaming full overwrites between them
+  vrfBypass: Boolean = false,    // forward pipe writebacks into VRF reads of the same eg in the same cycle
 
   issStructure: VectorIssueStructure = VectorIssueStructure.Unified,
 
@@ -371,18 +389,17 @@ case class VectorParams(
 
   // Add OPU to design
   useOpu : Boolean = false,
+  opuParams : OPUParameters = OPUParameters(),
 ) {
-  def opuInsns = Seq(
-    saturn.insns.OPMACC.VV,
-    saturn.insns.OPMVIN.VX,
-    saturn.insns.OPMVINBCAST.VX,
-    saturn.insns.OPMVOUT.VX)
+  def opuInsns = opuParams.insns
   def supported_ex_insns = issStructure.generate(this).map(_.insns).flatten ++ (if (useOpu) opuInsns else Nil)
 
   require(dLen >= 64, "dLen must be >= 64")
   require((dLen & (dLen - 1)) == 0, "dLen must be power of 2")
   require(mLen >= 64 && mLen <= 512, "mLen must be >= 64 and <= 512")
   require((mLen & (mLen - 1)) == 0, "mLen must be power of 2")
+  require(!(vrfRenaming && intervalHazards), "renamed vregs are not contiguous eg ranges")
+  require(!(vrfSRAM && vrfBypass), "SRAM reads return after the forwarded write has landed")
 }
 
 case object VectorParamsKey extends Field[VectorParams]
@@ -401,22 +418,34 @@ trait HasVectorParams extends HasVectorConsts { this: HasCoreParameters =>
 
   def useOpu = vParams.useOpu
 
-  def opuParams = OPUParameters(8, 8, 32, 33, 2)
+  def opuParams = vParams.opuParams
 
   def dmemTagBits = log2Ceil(vParams.vlifqEntries.max(vParams.vsifqEntries))
   def sgmemTagBits = log2Ceil(vParams.vsgifqEntries)
+  def prefetchTagBits = log2Ceil(vParams.prefetchLines) max 1
   def egsPerVReg = vLen / dLen
-  def egsTotal = (vLen / dLen) * 32
+  def nPhysVRegs = if (vParams.vrfRenaming) 64 else 32
+  def egsTotal = (vLen / dLen) * nPhysVRegs
   def vrfBankBits = log2Ceil(vParams.vrfBanking)
   def lsiqIdBits = log2Ceil(vParams.vliqEntries.max(vParams.vsiqEntries))
   val debugIdSz = 16
-  def nRelease = vParams.issStructure.generate(vParams).map(_.seqs.size).reduce(_+_) + 2 + (if (useOpu) 1 else 0) // load/stores/opu
+  def nRelease = vParams.issStructure.generate(vParams).map(_.seqs.size).reduce(_+_) + 2 + (if (useOpu) 2 else 0) // load/stores/opu maccs+moves
 
   def getEgId(vreg: UInt, eidx: UInt, eew: UInt, bitwise: Bool): UInt = {
     val base = vreg << log2Ceil(egsPerVReg)
     val off = eidx >> Mux(bitwise, log2Ceil(dLen).U, (log2Ceil(dLenB).U - eew))
     base +& off
   }
+  // With vrfRenaming, home holds one bit per vreg selecting which of its
+  // two physical copies is accessed
+  def physEg(eg: UInt, home: UInt): UInt = if (vParams.vrfRenaming) {
+    val arch_eg = eg(log2Ceil(32 * egsPerVReg)-1,0)
+    Cat(home(arch_eg >> log2Ceil(egsPerVReg)), arch_eg)
+  } else eg
+  def physVReg(vreg: UInt, home: UInt): UInt = if (vParams.vrfRenaming) Cat(home(vreg), vreg) else vreg
+  def physVRegs(mask: UInt, home: UInt): UInt = if (vParams.vrfRenaming) Cat(mask & home, mask & ~home) else mask
+  def isV0Eg(eg: UInt): Bool = eg(log2Ceil(32 * egsPerVReg)-1,0) < egsPerVReg.U
+
   def getByteId(vreg: UInt, eidx: UInt, eew: UInt): UInt = {
     Cat(getEgId(vreg, eidx, eew, false.B), (eidx << eew)(log2Ceil(dLenB)-1,0))
   }
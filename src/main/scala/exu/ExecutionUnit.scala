@@ -21,6 +21,7 @@ class ExecutionUnit(genFUs: Seq[FunctionalUnitFactory], desc: String)(implicit p
 
   val io = IO(new Bundle {
     val iss = Flipped(Decoupled(new ExecuteMicroOpWithData(nFUs)))
+    val iss_late = Input(new ExecuteLateOperands)
     val iter_hazards = Output(Vec(iter_fus.size, Valid(new PipeHazard(maxPipeDepth))))
     val iter_write = Decoupled(new VectorWrite(dLen))
     val pipe_write = Output(Valid(new VectorWrite(dLen)))
@@ -77,6 +78,7 @@ class ExecutionUnit(genFUs: Seq[FunctionalUnitFactory], desc: String)(implicit p
     fu.io.iss.op := io.iss.bits
     fu.io.iss.valid := io.iss.valid && io.iss.bits.fu_sel(i) && !fu.io.stall
   }
+  iter_fus.foreach(_._1.io.iss_late := io.iss_late)
 
   val pipe_write = WireInit(false.B)
 
@@ -105,18 +107,21 @@ class ExecutionUnit(genFUs: Seq[FunctionalUnitFactory], desc: String)(implicit p
       pipe_bits.head      := io.iss.bits
     }
 
+    // Operands that SRAM VRF banks return late land in the first stage
+    val pipe_ops = io.iss_late.merge(pipe_bits.head) +: pipe_bits.tail
+
     for (i <- 1 until maxPipeDepth) {
       val fire = pipe_valids(i-1)
       pipe_valids(i) := fire && pipe_bits(i-1).pipe_depth =/= (i-1).U
       when (fire) {
-        pipe_bits(i)      := pipe_bits(i-1)
+        pipe_bits(i)      := pipe_ops(i-1)
       }
     }
     for ((fu, j) <- pipe_fus) {
       for (i <- 0 until fu.depth) {
         fu.io.pipe(i).valid := pipe_valids(i) && pipe_bits(i).fu_sel(j)
         fu.io.pipe(i).bits  := Mux(pipe_valids(i) && pipe_bits(i).fu_sel(j),
-          pipe_bits(i), 0.U.asTypeOf(new ExecuteMicroOpWithData(nFUs)))
+          pipe_ops(i), 0.U.asTypeOf(new ExecuteMicroOpWithData(nFUs)))
       }
     }
 
@@ -151,6 +156,16 @@ class ExecutionUnit(genFUs: Seq[FunctionalUnitFactory], desc: String)(implicit p
         io.pipe_hazards(0).bits.eg := fu.io.write.bits.eg
       }
     }
+
+    // The VRF forwards a pipe write to reads of its eg in the same cycle,
+    // so the writing stage no longer holds off dependent reads
+    if (vParams.vrfBypass) {
+      for (i <- 0 until maxPipeDepth) {
+        when (write_pipe_sel(i) && io.pipe_write.valid && io.pipe_write.bits.eg === io.pipe_hazards(i).bits.eg) {
+          io.pipe_hazards(i).valid := false.B
+        }
+      }
+    }
   }
 
   if (iter_fus.size > 0) {
@@ -28,6 +28,7 @@ class PipelinedFunctionalUnitIO(depth: Int)(implicit p: Parameters) extends Func
 }
 
 class IterativeFunctionalUnitIO(implicit p: Parameters) extends FunctionalUnitIO {
+  val iss_late = Input(new ExecuteLateOperands)
   val write = Decoupled(new VectorWrite(dLen))
   val hazard = Output(Valid(new PipeHazard(10)))
   val acc = Output(Bool())
@@ -68,15 +69,25 @@ abstract class IterativeFunctionalUnit(implicit p: Parameters) extends Functiona
   val io = IO(new IterativeFunctionalUnitIO)
 
   val valid = RegInit(false.B)
-  val op = Reg(new ExecuteMicroOpWithData(1))
+  val op_reg = Reg(new ExecuteMicroOpWithData(1))
   val last = Wire(Bool())
 
+  // SRAM VRF banks return the operands the cycle after issue
+  val op = if (vParams.vrfSRAM) {
+    val late = RegNext(io.iss.valid, false.B)
+    val merged = Mux(late, io.iss_late.merge(op_reg), op_reg)
+    when (late) { op_reg := merged }
+    merged
+  } else {
+    op_reg
+  }
+
   io.busy := valid
 
   when (io.iss.valid) {
     assert(!valid || last)
     valid := true.B
-    op := io.iss.op
+    op_reg := io.iss.op
   } .elsewhen (last) {
     valid := false.B
   }
@@ -20,16 +20,54 @@ case class OPUParameters (
   val aWidth : Int = 8,
   val bWidth : Int = 8,
   val cWidth : Int = 32, // Accumulator size
-  val cWidthRec : Int = 33,
 
-  val nMrfRegs : Int = 2
-)
+  // Number of accumulator tiles. Tile registers are selected by the
+  // low bits of the instruction's register specifier
+  val nMrfRegs : Int = 2,
+
+  // Shrinks the array to operate on dLen/dimDivisor-bit slices of each
+  // operand element group, trading MACC throughput for area
+  val dimDivisor : Int = 1,
+
+  // Stages from operands to accumulation. The accumulate itself stays
+  // single-cycle, so back-to-back maccs to the same tile never stall
+  val maccPipeDepth : Int = 1,
+
+  // Supported multiply-accumulate input types
+  val types : Seq[OPUTypes.Value] = Seq(OPUTypes.INT8, OPUTypes.E4M3, OPUTypes.E5M2)
+) {
+  def hasInt = types.contains(OPUTypes.INT8)
+  def hasFP8 = types.contains(OPUTypes.E4M3) || types.contains(OPUTypes.E5M2)
+
+  require(hasInt || hasFP8, "OPU must support at least one input type")
+  require(!types.contains(OPUTypes.INT16) && !types.contains(OPUTypes.INT32), "OPU only supports 8-bit inputs")
+  require(maccPipeDepth >= 1)
+  require(aWidth == 8 && bWidth == 8, "OPU only supports 8-bit inputs")
+  require(cWidth == 16 || cWidth == 32)
+  require(!hasFP8 || cWidth == 32, "FP8 OPU requires FP32 accumulators")
+  require(isPow2(nMrfRegs) && nMrfRegs >= 2 && nMrfRegs <= 8)
+  require(isPow2(dimDivisor))
+
+  // maccs and moves are sequenced separately, so they can overlap on different tiles
+  def maccInsns =
+    (if (hasInt) Seq(saturn.insns.OPMACCI.VV) else Nil) ++
+    (if (hasFP8) Seq(saturn.insns.OPMACC.VV) else Nil)
+  def moveInsns = Seq(
+    saturn.insns.OPMVIN.VX,
+    saturn.insns.OPMVINBCAST.VX,
+    saturn.insns.OPMVOUT.VX)
+  def insns = moveInsns ++ maccInsns
+}
 
 trait HasOPUParams extends HasVectorParams { this: HasCoreParameters =>
-  def varchRatio = vLen / dLen
+  // operand bits consumed by the array per cycle
+  def opuLen = dLen / opuParams.dimDivisor
+  def sliceBits = log2Ceil(opuParams.dimDivisor)
+  def varchRatio = vLen / opuLen
   def regsPerTileReg = varchRatio * varchRatio
   def regsPerCell = regsPerTileReg * opuParams.nMrfRegs
   def cellRegIdxBits = log2Ceil(regsPerCell)
+  def tileIdxBits = log2Ceil(opuParams.nMrfRegs)
   def prodWidth = opuParams.aWidth + opuParams.bWidth
 
   def wideningFactor = opuParams.cWidth / opuParams.aWidth
@@ -37,126 +75,44 @@ trait HasOPUParams extends HasVectorParams { this: HasCoreParameters =>
   def clusterXdim = opuParams.cWidth / opuParams.bWidth
   def clusterYdim = clusterXdim
 
-  def yDim = (dLen / opuParams.aWidth) / clusterYdim
-  def xDim = (dLen / opuParams.bWidth) / clusterXdim
+  def yDim = (opuLen / opuParams.aWidth) / clusterYdim
+  def xDim = (opuLen / opuParams.bWidth) / clusterXdim
+
+  // cycles from mvout issue to VRF write, the same for every row
+  def mvoutLatency = opuParams.maccPipeDepth + 2
 
+  // select the opuLen-bit slice of a dLen-bit element group
+  def opuSlice(data: UInt, slice: UInt): UInt = if (sliceBits == 0) data else {
+    data.asTypeOf(Vec(opuParams.dimDivisor, UInt(opuLen.W)))(slice(sliceBits-1,0))
+  }
 }
 
 
 /*
  * A single cell in the Outer Product Unit MACC array
- * Accumulation register alse serve as pipeline registers
- * during read out
+ *
+ * Accumulators hold raw INT32 or IEEE FP32 bits, so mvin/mvout
+ * are agnostic to the format of the following maccs. The fp
+ * control selects between the INT8 and FP8 datapaths; only the
+ * datapaths for the configured OPUTypes are instantiated.
+ *
+ * The multiplier operands arrive maccPipeDepth-1 cycles ahead of
+ * the remaining control. Products are pipelined to meet the control,
+ * and the accumulator is read and written in that final stage.
  */
-// class OuterProductCell(implicit p: Parameters) extends CoreModule()(p) with HasOPUParams {
-//
-//   val io = IO(new Bundle{
-//     // Data signals
-//     val in_l = Input(SInt(opuParams.aWidth.W)) // left input
-//     val in_t = Input(SInt(opuParams.bWidth.W)) // top input
-//
-//     // Contol Signals
-//     val mrf_idx = Input(UInt(cellRegIdxBits.W)) // Index for µarch register to write
-//
-//     val macc = Input(Bool())
-//     val mvin = Input(Bool())
-//     val mvin_bcast = Input(Bool())
-//     val mvin_data = Input(SInt(opuParams.cWidth.W))
-//     val out = Output(SInt(opuParams.cWidth.W))
-//   })
-//   // Matrix Register + Logic
-//   val regs = Reg(Vec(regsPerCell, SInt(opuParams.cWidth.W)))
-//
-//   // TODO: Need to check for overflow and saturate to accumulator width
-//   val prod = Mux(io.macc, io.in_l * io.in_t, 0.S)
-//   val sum = prod + regs(io.mrf_idx)
-//
-//   // Data going into MRF
-//   for (i <- 0 until regsPerCell) {
-//     val tile_match = (io.mrf_idx >> log2Ceil(regsPerTileReg)) === (i >> log2Ceil(regsPerTileReg)).U
-//     val subtile_match = io.mrf_idx(log2Ceil(regsPerTileReg)-1,0) === (i % regsPerTileReg).U
-//
-//     when (tile_match && (((io.mvin || io.macc) && subtile_match) || io.mvin_bcast)) {
-//       regs(i) := Mux(io.macc, sum, io.mvin_data)
-//     }
-//   }
-//
-//   io.out := regs(io.mrf_idx)
-// }
-
-// class OuterProductCell(implicit p: Parameters) extends CoreModule()(p) with HasOPUParams {
-
-//   val io = IO(new Bundle{
-//     // Data signals
-//     val in_l = Input(SInt(opuParams.aWidth.W)) // left input
-//     val in_t = Input(SInt(opuParams.bWidth.W)) // top input
-
-//     // Contol Signals
-//     val mrf_idx = Input(UInt(cellRegIdxBits.W)) // Index for µarch register to write
-//     val altfmt = Input(Bool()) // alternate format for outer product
-
-//     val macc = Input(Bool())
-//     val mvin = Input(Bool())
-//     val mvin_bcast = Input(Bool())
-//     val mvin_data = Input(SInt(opuParams.cWidth.W))
-//     val out = Output(UInt(opuParams.cWidth.W))
-//   })
-
-//     def widen(in: UInt, inT: FType, outT: FType, active: Bool): UInt = {
-//       val widen = Module(new hardfloat.RecFNToRecFN(inT.exp, inT.sig, outT.exp, outT.sig))
-//       widen.io.in := Mux(active, in, 0.U)
-//       widen.io.roundingMode := hardfloat.consts.round_near_even
-//       widen.io.detectTininess := hardfloat.consts.tininess_afterRounding
-//       widen.io.out
-//     }
-
-//   // Matrix Register + Logic
-//   val regs = Reg(Vec(regsPerCell, UInt(opuParams.cWidthRec.W)))
-
-//   val f8a = FType.E5M3.recode(fp8ToE5M3(io.in_l.asUInt, io.altfmt))
-//   val f8b = FType.E5M3.recode(fp8ToE5M3(io.in_t.asUInt, io.altfmt))
-//   val f8aw = widen(f8a, FType.E5M3, FType.S, io.macc)
-//   val f8bw = widen(f8b, FType.E5M3, FType.S, io.macc)
-
-//   val fma = Module(new MulAddRecFNPipe(0, FType.S.exp, FType.S.sig))
-//   fma.io.validin := io.macc
-//   fma.io.op := 0.U // FMA
-//   fma.io.roundingMode := hardfloat.consts.round_near_even
-//   fma.io.detectTininess := hardfloat.consts.tininess_afterRounding
-//   fma.io.a := f8aw
-//   fma.io.b := f8bw
-//   fma.io.c := regs(io.mrf_idx)
-
-//   val sum = Mux(fma.io.validout, fma.io.out, 0.U)
-
-//   // // TODO: Need to check for overflow and saturate to accumulator width
-//   // val prod = Mux(io.macc, io.in_l * io.in_t, 0.S)
-//   // val sum = prod + regs(io.mrf_idx)
-
-//   // Data going into MRF
-//   for (i <- 0 until regsPerCell) {
-//     val tile_match = (io.mrf_idx >> log2Ceil(regsPerTileReg)) === (i >> log2Ceil(regsPerTileReg)).U
-//     val subtile_match = io.mrf_idx(log2Ceil(regsPerTileReg)-1,0) === (i % regsPerTileReg).U
-
-//     when (tile_match && (((io.mvin || io.macc) && subtile_match) || io.mvin_bcast)) {
-//       regs(i) := Mux(io.macc, sum, FType.S.recode(io.mvin_data.asUInt))
-//     }
-//   }
-
-//   // io.out := 0.U
-//   io.out := FType.S.ieee(regs(io.mrf_idx))
-// }
-
 class OuterProductCell(implicit p: Parameters) extends CoreModule()(p) with HasOPUParams {
 
   val io = IO(new Bundle{
     // Data signals
     val in_l = Input(SInt(opuParams.aWidth.W)) // left input
     val in_t = Input(SInt(opuParams.bWidth.W)) // top input
+    val altfmt = Input(Bool()) // alternate format for outer product
+    val mul = Input(Bool()) // operands are valid
 
     // Contol Signals
-    val mrf_idx = Input(UInt(cellRegIdxBits.W)) // Index for µarch register to write
-    val altfmt = Input(Bool()) // alternate format for outer product
+    val mrf_idx = Input(UInt(cellRegIdxBits.W)) // Index for µarch register to accumulate
+    val mv_mrf_idx = Input(UInt(cellRegIdxBits.W)) // Index for µarch register to mvin/mvout
+    val fp = Input(Bool()) // FP8 (vs INT8) multiply-accumulate
 
     val macc = Input(Bool())
     val mvin = Input(Bool())
@@ -165,60 +121,57 @@ class OuterProductCell(implicit p: Parameters) extends CoreModule()(p) with HasO
     val out = Output(UInt(opuParams.cWidth.W))
   })
 
-    def widen(in: UInt, inT: FType, outT: FType, active: Bool): UInt = {
-      val widen = Module(new hardfloat.RecFNToRecFN(inT.exp, inT.sig, outT.exp, outT.sig))
-      widen.io.in := Mux(active, in, 0.U)
-      widen.io.roundingMode := hardfloat.consts.round_near_even
-      widen.io.detectTininess := hardfloat.consts.tininess_afterRounding
-      widen.io.out
-    }
-
   // Matrix Register + Logic
-  val regs = Reg(Vec(regsPerCell, UInt(opuParams.cWidthRec.W)))
-
-  val f8a = FType.E5M3.recode(fp8ToE5M3(io.in_l.asUInt, io.altfmt))
-  val f8b = FType.E5M3.recode(fp8ToE5M3(io.in_t.asUInt, io.altfmt))
-  val f8aw = widen(f8a, FType.E5M3, FType.BF16, io.macc)
-  val f8bw = widen(f8b, FType.E5M3, FType.BF16, io.macc)
-
-  val fma = Module(new MulAddRecFNPipe(0, FType.BF16.exp, FType.BF16.sig))
-  fma.io.validin := io.macc
-  fma.io.op := 0.U // FMA
-  fma.io.roundingMode := hardfloat.consts.round_near_even
-  fma.io.detectTininess := hardfloat.consts.tininess_afterRounding
-  fma.io.a := f8aw
-  fma.io.b := f8bw
-  fma.io.c := 0.U
-
-  val resultw = widen(fma.io.out, FType.BF16, FType.S, fma.io.validout)
-
-  val fma2 = Module(new MulAddRecFNPipe(0, FType.S.exp, FType.S.sig))
-  fma2.io.validin := fma.io.validout
-  fma2.io.op := 0.U // FMA2
-  fma2.io.roundingMode := hardfloat.consts.round_near_even
-  fma2.io.detectTininess := hardfloat.consts.tininess_afterRounding
-  fma2.io.a := resultw
-  fma2.io.b := FType.S.recode("h3F800000".U) // 1.0 in recoded
-  fma2.io.c := regs(io.mrf_idx)
-
-  val sum = Mux(fma2.io.validout, fma2.io.out, 0.U)
-
-  // // TODO: Need to check for overflow and saturate to accumulator width
-  // val prod = Mux(io.macc, io.in_l * io.in_t, 0.S)
-  // val sum = prod + regs(io.mrf_idx)
+  val regs = Reg(Vec(regsPerCell, UInt(opuParams.cWidth.W)))
+  val acc = regs(io.mrf_idx)
+
+  // Integer accumulation wraps modulo 2^cWidth, like vmacc
+  val int_sum = Option.when(opuParams.hasInt) {
+    val prod = Pipe(io.mul, io.in_l * io.in_t, opuParams.maccPipeDepth - 1).bits
+    (prod +% acc.asSInt).asUInt
+  }
+
+  val fp_sum = Option.when(opuParams.hasFP8) {
+    val prod = Pipe(io.mul, fp8ExactMul(io.in_l.asUInt, io.in_t.asUInt, io.altfmt), opuParams.maccPipeDepth - 1).bits
+    val fp_macc = io.macc && io.fp
+
+    val adder = Module(new AddRawFN(FType.S.exp, FType.S.sig))
+    adder.io.subOp := false.B
+    adder.io.a := rawFloatFromFN(FType.S.exp, FType.S.sig, Mux(fp_macc, acc, 0.U))
+    adder.io.b := prod
+    adder.io.roundingMode := hardfloat.consts.round_near_even
+
+    val round = Module(new RoundRawFNToRecFN(FType.S.exp, FType.S.sig, 0))
+    round.io.invalidExc := adder.io.invalidExc
+    round.io.infiniteExc := false.B
+    round.io.in := adder.io.rawOut
+    round.io.roundingMode := hardfloat.consts.round_near_even
+    round.io.detectTininess := hardfloat.consts.tininess_afterRounding
+
+    FType.S.ieee(round.io.out)
+  }
+
+  val sum = (int_sum, fp_sum) match {
+    case (Some(i), Some(f)) => Mux(io.fp, f, i)
+    case (Some(i), None) => i
+    case (None, Some(f)) => f
+    case _ => 0.U
+  }
 
   // Data going into MRF
+  // maccs and moves may target different tiles in the same cycle
   for (i <- 0 until regsPerCell) {
-    val tile_match = (io.mrf_idx >> log2Ceil(regsPerTileReg)) === (i >> log2Ceil(regsPerTileReg)).U
-    val subtile_match = io.mrf_idx(log2Ceil(regsPerTileReg)-1,0) === (i % regsPerTileReg).U
+    val tile_match = (io.mv_mrf_idx >> log2Ceil(regsPerTileReg)) === (i >> log2Ceil(regsPerTileReg)).U
+    val subtile_match = io.mv_mrf_idx(log2Ceil(regsPerTileReg)-1,0) === (i % regsPerTileReg).U
 
-    when (tile_match && (((io.mvin || io.macc) && subtile_match) || io.mvin_bcast)) {
-      regs(i) := Mux(io.macc, sum, FType.S.recode(io.mvin_data.asUInt))
+    when (io.macc && io.mrf_idx === i.U) {
+      regs(i) := sum
+    } .elsewhen (tile_match && ((io.mvin && subtile_match) || io.mvin_bcast)) {
+      regs(i) := io.mvin_data.asUInt
     }
   }
 
-  // io.out := 0.U
-  io.out := FType.S.ieee(regs(io.mrf_idx))
+  io.out := regs(io.mv_mrf_idx)
 }
 
 class OuterProductCluster(implicit p : Parameters) extends CoreModule()(p) with HasOPUParams {
@@ -226,23 +179,26 @@ class OuterProductCluster(implicit p : Parameters) extends CoreModule()(p) with
     val in_l      = Input(Vec(clusterYdim, UInt(opuParams.aWidth.W)))
     val in_t      = Input(Vec(clusterXdim, UInt(opuParams.bWidth.W)))
 
-    val in_pipe   = Input(UInt(opuParams.cWidth.W))
-    val out_pipe  = Output(UInt(opuParams.cWidth.W))
+    val mul       = Input(Bool())
+    val altfmt    = Input(Bool()) // alternate format for outer product
+
+    val out       = Output(UInt(opuParams.cWidth.W))
 
     val mrf_idx = Input(UInt(cellRegIdxBits.W))
+    val mv_mrf_idx = Input(UInt(cellRegIdxBits.W))
     val row_idx = Input(UInt(log2Ceil(clusterYdim).W))
     val col_idx = Input(UInt(log2Ceil(clusterXdim).W))
 
     val macc  = Input(Bool())
-    val shift = Input(Bool())
+    val mvout = Input(Bool())
     val mvin  = Input(Bool())
     val mvin_bcast = Input(Bool())
-    val altfmt = Input(Bool()) // alternate format for outer product
+    val mvin_data = Input(UInt(opuParams.cWidth.W))
+    val fp = Input(Bool()) // FP8 (vs INT8) multiply-accumulate
   })
 
   val cells = Seq.fill(clusterXdim, clusterYdim)(Module(new OuterProductCell))
   val cell_outs = Wire(Vec(clusterYdim, Vec(clusterXdim, UInt(opuParams.cWidth.W))))
-  val pipe = Reg(UInt(opuParams.cWidth.W))
 
   for (i <- 0 until clusterYdim) {
     for (j <- 0 until clusterXdim) {
@@ -250,23 +206,21 @@ class OuterProductCluster(implicit p : Parameters) extends CoreModule()(p) with
 
       cell.io.in_l  := io.in_l(i).asSInt
       cell.io.in_t  := io.in_t(j).asSInt
+      cell.io.mul := io.mul
+      cell.io.altfmt := io.altfmt
 
       cell.io.macc := io.macc
       cell.io.mvin := io.mvin && i.U === io.row_idx && j.U === io.col_idx
       cell.io.mvin_bcast := io.mvin_bcast && j.U === io.col_idx
-      cell.io.mvin_data := io.in_t.asUInt.asSInt
+      cell.io.mvin_data := io.mvin_data.asSInt
       cell.io.mrf_idx := io.mrf_idx
-      cell.io.altfmt := io.altfmt
+      cell.io.mv_mrf_idx := io.mv_mrf_idx
+      cell.io.fp := io.fp
       cell_outs(i)(j) := cell.io.out.asUInt
     }
   }
 
-  pipe := Mux(io.shift,
-    io.in_pipe,
-    cell_outs(io.row_idx)(io.col_idx)
-  )
-
-  io.out_pipe := pipe
+  io.out := RegEnable(cell_outs(io.row_idx)(io.col_idx), io.mvout)
 }
 
 class OuterProductControl(implicit p: Parameters) extends CoreBundle()(p) with HasOPUParams {
@@ -275,15 +229,19 @@ class OuterProductControl(implicit p: Parameters) extends CoreBundle()(p) with H
   val in_l      = Vec(yDim, Vec(clusterYdim, UInt(opuParams.aWidth.W)))
   val in_t      = Vec(xDim, Vec(clusterXdim, UInt(opuParams.bWidth.W)))
 
+  val mvin_data = Vec(xDim, UInt(opuParams.cWidth.W))
+
   // same values broadcast horizontally
   val mrf_idx    = Vec(yDim, UInt(cellRegIdxBits.W))
+  val mv_mrf_idx = Vec(yDim, UInt(cellRegIdxBits.W))
   val row_idx    = Vec(yDim, UInt(log2Ceil(clusterYdim).W))
   val col_idx    = Vec(yDim, UInt(log2Ceil(clusterXdim).W))
   val macc       = Vec(yDim, Bool())
   val mvin       = Vec(yDim, Bool())
   val mvin_bcast = Vec(yDim, Bool())
-  val shift      = Vec(yDim, Bool())
+  val mvout      = Vec(yDim, Bool())
   val altfmt    = Bool() // alternate format for outer product
+  val fp        = Bool() // FP8 (vs INT8) multiply-accumulate
 }
 
 
@@ -294,35 +252,43 @@ class OuterProductUnit(implicit p: Parameters) extends CoreModule()(p) with HasO
     val YOU_SHALL_PASS = Output(Bool())
   })
 
+  // The multipliers see the operands as issued, everything else is
+  // delayed to meet the products at the accumulators
+  val op_late = ShiftRegister(io.op, opuParams.maccPipeDepth - 1)
+  val clock_enables = Seq.iterate(io.op.clock_enable, opuParams.maccPipeDepth)(e => RegNext(e, false.B))
+
   // clock gating
-  val gated_clock = ClockGate(clock, io.op.clock_enable, "opu_clock_gate")
+  val gated_clock = ClockGate(clock, clock_enables.reduce(_||_), "opu_clock_gate")
 
   // Force OuterProductUnit to have logic to be syn-mappable
-  io.YOU_SHALL_PASS := io.op.macc(0) & io.op.macc(0) | io.op.shift(0)
+  io.YOU_SHALL_PASS := io.op.macc(0) & io.op.macc(0) | io.op.mvout(0)
   dontTouch(io.YOU_SHALL_PASS)
 
   val clusters = Seq.fill(yDim, xDim)(withClock(gated_clock) { Module(new OuterProductCluster) })
+  val mvout_sel = RegNext(op_late.mvout)
 
   for (j <- 0 until xDim) {
     for (i <- 0 until yDim) {
       val cluster = clusters(i)(j)
       cluster.io.in_l      := io.op.in_l(i)
       cluster.io.in_t      := io.op.in_t(j)
-
-      cluster.io.mrf_idx    := io.op.mrf_idx(i)
-      cluster.io.row_idx    := io.op.row_idx(i)
-      cluster.io.col_idx    := io.op.col_idx(i)
-      cluster.io.macc       := io.op.macc(i)
-      cluster.io.mvin       := io.op.mvin(i)
-      cluster.io.mvin_bcast := io.op.mvin_bcast(i)
-      cluster.io.shift      := io.op.shift(i)
-      cluster.io.altfmt     := io.op.altfmt
+      cluster.io.mul       := io.op.macc(i)
+      cluster.io.altfmt    := io.op.altfmt
+
+      cluster.io.mrf_idx    := op_late.mrf_idx(i)
+      cluster.io.mv_mrf_idx := op_late.mv_mrf_idx(i)
+      cluster.io.row_idx    := op_late.row_idx(i)
+      cluster.io.col_idx    := op_late.col_idx(i)
+      cluster.io.macc       := op_late.macc(i)
+      cluster.io.mvin       := op_late.mvin(i)
+      cluster.io.mvin_bcast := op_late.mvin_bcast(i)
+      cluster.io.mvin_data  := op_late.mvin_data(j)
+      cluster.io.mvout      := op_late.mvout(i)
+      cluster.io.fp         := op_late.fp
     }
 
-    clusters(0)(j).io.in_pipe := 0.U
-    for (i <- 1 until yDim) {
-      clusters(i)(j).io.in_pipe := clusters(i-1)(j).io.out_pipe
-    }
-    io.out(j) := clusters(yDim-1)(j).io.out_pipe
+    // every cluster row drives the column readout directly, so mvouts
+    // of different rows can be issued back-to-back
+    io.out(j) := Mux1H(mvout_sel, clusters.map(_(j).io.out))
   }
 }
@@ -45,7 +45,7 @@ class PermuteUnit(implicit p: Parameters) extends PipelinedFunctionalUnit(1)(p)
   val rgather_elem = Mux(io.pipe(0).bits.head || io.pipe(0).bits.funct3 === OPIVV, elem, result_reg)
   val splat = dLenSplat(Mux(compress, elem, rgather_elem), io.pipe(0).bits.rvs2_eew)
 
-  val compress_wvd = Mux(io.pipe(0).bits.head, io.pipe(0).bits.wvd_eg >> log2Ceil(egsPerVReg), wvd_reg)
+  val compress_wvd = Mux(io.pipe(0).bits.head, io.pipe(0).bits.wvd_eg >> log2Ceil(egsPerVReg), wvd_reg)(4,0)
   val compress_bit = (io.pipe(0).bits.rvs1_data >> io.pipe(0).bits.eidx(log2Ceil(dLen)-1,0))(0)
   val compress_eidx = Mux(io.pipe(0).bits.head, 0.U, result_reg)(log2Ceil(maxVLMax),0)
 
@@ -74,7 +74,34 @@ class PermuteUnit(implicit p: Parameters) extends PipelinedFunctionalUnit(1)(p)
   val use_rvs1_mask = FillInterleaved(8, Mux(slide1, slide1_mask, 0.U).pad(dLenB))
 
   val wmask = Mux(mvnrr, ~(0.U(dLenB.W)),
-    Mux(compress, Mux(compress_bit, shifted_mask, 0.U), io.pipe(0).bits.wmask))
+    Mux(compress, Mux(compress_bit, shifted_mask, 0.U),
+      io.pipe(0).bits.wmask & Mux(xbar_gather, xbar_mask, ~(0.U(dLenB.W)))))
+
+  // Crossbar gather: each pass reads one source element group, writes the
+  // elements whose index falls in it, and zeroes out-of-range elements
+  // on the first pass. scalar holds vlmax
+  val xbar_gather = io.pipe(0).bits.xbar_gather
+  val gather_eg = io.pipe(0).bits.gather_eg
+  val xbar_vlmax = io.pipe(0).bits.scalar
+  val xbar = Seq.tabulate(4) { sew =>
+    val n = dLenB >> sew
+    val src = io.pipe(0).bits.rvs2_data.asTypeOf(Vec(n, UInt((8 << sew).W)))
+    def index(s: Int, ieew: Int): UInt = {
+      val m = dLenB >> ieew
+      val idxs = io.pipe(0).bits.rvs1_data.asTypeOf(Vec(m, UInt((8 << ieew).W)))
+      if (ieew == sew) idxs(s) else idxs((io.pipe(0).bits.eidx + s.U)(log2Ceil(m)-1,0))
+    }
+    val elems = Seq.tabulate(n) { s =>
+      val idx = if (sew > 1) Mux(rgatherei16, index(s, 1), index(s, sew)) else index(s, sew)
+      val hit = idx < xbar_vlmax && (idx >> log2Ceil(n)) === gather_eg
+      val zero = idx >= xbar_vlmax && gather_eg === 0.U
+      val data = if (n == 1) src(0) else src(idx(log2Ceil(n)-1,0))
+      (Mux(hit, data, 0.U), hit || zero)
+    }
+    (VecInit(elems.map(_._1)).asUInt, FillInterleaved(1 << sew, VecInit(elems.map(_._2)).asUInt))
+  }
+  val xbar_data = VecInit(xbar.map(_._1))(io.pipe(0).bits.rvs2_eew)
+  val xbar_mask = VecInit(xbar.map(_._2))(io.pipe(0).bits.rvs2_eew)
 
   io.scalar_write.valid := false.B
   io.scalar_write.bits := DontCare
@@ -84,10 +111,10 @@ class PermuteUnit(implicit p: Parameters) extends PipelinedFunctionalUnit(1)(p)
 
   io.write.valid := io.pipe(0).valid && (!compress || compress_bit)
   io.write.bits.eg := Mux(compress,
-    getEgId(compress_wvd, compress_eidx, io.pipe(0).bits.rvs2_eew, false.B),
+    physEg(getEgId(compress_wvd, compress_eidx, io.pipe(0).bits.rvs2_eew, false.B), io.pipe(0).bits.whome),
     io.pipe(0).bits.wvd_eg)
   io.write.bits.mask := FillInterleaved(8, wmask)
-  io.write.bits.data := Mux(rgather || compress,
+  io.write.bits.data := Mux(xbar_gather, xbar_data, Mux(rgather || compress,
     splat,
-    (io.pipe(0).bits.rvs2_data & ~use_rvs1_mask) | (io.pipe(0).bits.rvs1_data & use_rvs1_mask))
+    (io.pipe(0).bits.rvs2_data & ~use_rvs1_mask) | (io.pipe(0).bits.rvs1_data & use_rvs1_mask)))
 }
@@ -227,79 +227,80 @@ class VFRSQRT7(implicit p: Parameters) extends FPUModule()(p) {
 
 }
 
-case object FPDivSqrtFactory extends FunctionalUnitFactory {
-  def insns = Seq(
+// With divSqrt false, vfdiv/vfsqrt are left to SIMDFPDivSqrt
+case class FPDivSqrtFactory(divSqrt: Boolean) extends FunctionalUnitFactory {
+  def divSqrtInsns = Seq(
     FDIV.VV, FDIV.VF,
     FRDIV.VF,
-    FSQRT_V,
+    FSQRT_V
+  ).map(_.restrictSEW(1,2,3)).flatten
+
+  def insns = ((if (divSqrt) divSqrtInsns else Nil) ++ Seq(
     FRSQRT7_V,
     FREC7_V,
     FCLASS_V
-  ).map(_.restrictSEW(1,2,3)).flatten.map(_.elementWise.iterative)
+  ).map(_.restrictSEW(1,2,3)).flatten).map(_.elementWise.iterative)
 
-  def generate(implicit p: Parameters) = new FPDivSqrt()(p)
+  def generate(implicit p: Parameters) = new FPDivSqrt(divSqrt)(p)
 }
 
-class FPDivSqrt(implicit p: Parameters) extends IterativeFunctionalUnit()(p) with HasFPUParameters {
-  val supported_insns = FPDivSqrtFactory.insns
+class FPDivSqrt(divSqrt: Boolean)(implicit p: Parameters) extends IterativeFunctionalUnit()(p) with HasFPUParameters {
+  val supported_insns = FPDivSqrtFactory(divSqrt).insns
   io.set_vxsat := false.B
 
-  val fTypes = Seq(FType.D, FType.S, FType.H)
-
-  val divSqrts = fTypes.map { ft =>
-    Module(new hardfloat.DivSqrtRecFN_small(ft.exp, ft.sig, 0))
-  }
-
-  val accept_inst = new VectorDecoder(
-    io.iss.op,
-    supported_insns,
-    Seq(FPSwapVdV2))
-
-  val ctrl = new VectorDecoder(
-    op,
-    supported_insns,
-    Seq(FPSwapVdV2))
-
   val div_op = op.opff6.isOneOf(OPFFunct6.fdiv, OPFFunct6.frdiv)
 
   val rvs2_bits = op.rvs2_elem
   val rvs1_bits = op.rvs1_elem
 
-  divSqrts.foreach { f =>
-    f.io.detectTininess := hardfloat.consts.tininess_afterRounding
-    f.io.roundingMode := op.frm
-    f.io.sqrtOp := !div_op
-  }
-
   io.hazard.valid := valid
   io.hazard.bits.eg := op.wvd_eg
   io.hazard.bits.vat := op.vat
 
-  val iss_fire_pipe = Reg(Bool())
-  iss_fire_pipe := io.iss.valid
+  val divsqrt_exc = Reg(UInt(5.W))
+  val divsqrt_reg = Reg(UInt(64.W))
+  val divsqrt_valid = RegInit(false.B)
 
-  val divSqrt_outs = divSqrts.zip(fTypes).map { case (f,ft) =>
-    val eew = log2Ceil(ft.ieeeWidth / 8)
-    f.io.inValid := iss_fire_pipe && op.rvd_eew === eew.U && (div_op || (op.opff6 === OPFFunct6.funary1 && op.rs1 === 0.U))
+  if (divSqrt) {
+    val fTypes = Seq(FType.D, FType.S, FType.H)
 
-    val recvs1 = ft.recode(rvs1_bits)
-    val recvs2 = ft.recode(rvs2_bits)
-    f.io.a := Mux(ctrl.bool(FPSwapVdV2) && div_op, recvs1, recvs2)
-    f.io.b := Mux(ctrl.bool(FPSwapVdV2) || !div_op, recvs2, recvs1)
-    Fill(64 / ft.ieeeWidth, ft.ieee(f.io.out))
-  }
+    val divSqrts = fTypes.map { ft =>
+      Module(new hardfloat.DivSqrtRecFN_small(ft.exp, ft.sig, 0))
+    }
 
-  val divSqrt_out_valid = divSqrts.map { d => d.io.outValid_div || d.io.outValid_sqrt }
-  val divSqrt_out = Mux1H(divSqrt_out_valid, divSqrt_outs)
+    val ctrl = new VectorDecoder(
+      op,
+      supported_insns,
+      Seq(FPSwapVdV2))
 
-  val divsqrt_exc = Reg(UInt(5.W))
-  val divsqrt_reg = Reg(UInt(64.W))
-  val divsqrt_valid = RegInit(false.B)
+    divSqrts.foreach { f =>
+      f.io.detectTininess := hardfloat.consts.tininess_afterRounding
+      f.io.roundingMode := op.frm
+      f.io.sqrtOp := !div_op
+    }
+
+    val iss_fire_pipe = Reg(Bool())
+    iss_fire_pipe := io.iss.valid
+
+    val divSqrt_outs = divSqrts.zip(fTypes).map { case (f,ft) =>
+      val eew = log2Ceil(ft.ieeeWidth / 8)
+      f.io.inValid := iss_fire_pipe && op.rvd_eew === eew.U && (div_op || (op.opff6 === OPFFunct6.funary1 && op.rs1 === 0.U))
+
+      val recvs1 = ft.recode(rvs1_bits)
+      val recvs2 = ft.recode(rvs2_bits)
+      f.io.a := Mux(ctrl.bool(FPSwapVdV2) && div_op, recvs1, recvs2)
+      f.io.b := Mux(ctrl.bool(FPSwapVdV2) || !div_op, recvs2, recvs1)
+      Fill(64 / ft.ieeeWidth, ft.ieee(f.io.out))
+    }
+
+    val divSqrt_out_valid = divSqrts.map { d => d.io.outValid_div || d.io.outValid_sqrt }
+    val divSqrt_out = Mux1H(divSqrt_out_valid, divSqrt_outs)
 
-  when (divSqrt_out_valid.orR) {
-    divsqrt_exc := Mux1H(divSqrt_out_valid, divSqrts.map(_.io.exceptionFlags))
-    divsqrt_reg := divSqrt_out
-    divsqrt_valid := true.B
+    when (divSqrt_out_valid.orR) {
+      divsqrt_exc := Mux1H(divSqrt_out_valid, divSqrts.map(_.io.exceptionFlags))
+      divsqrt_reg := divSqrt_out
+      divsqrt_valid := true.B
+    }
   }
   when (io.write.fire) {
     divsqrt_valid := false.B
@@ -349,3 +350,203 @@ class FPDivSqrt(implicit p: Parameters) extends IterativeFunctionalUnit()(p) wit
   io.acc := false.B
   io.tail := false.B
 }
+
+case object SIMDFPDivSqrtFactory extends FunctionalUnitFactory {
+  // Stages 1 to depth-2 each retire itersPerStage recurrence steps, enough
+  // for the sig+2 steps of an FP64 divide
+  def depth = 8
+  def itersPerStage = (FType.D.sig + 2 + depth - 3) / (depth - 2)
+
+  def insns = FPDivSqrtFactory(true).divSqrtInsns.map(_.pipelined(depth))
+
+  def generate(implicit p: Parameters) = new SIMDFPDivSqrt()(p)
+}
+
+class SIMDFPDivSqrtMeta extends Bundle {
+  val sign = Bool()
+  val sExp = SInt((FType.D.exp + 4).W)
+  val isNaN = Bool()
+  val isInf = Bool()
+  val isZero = Bool()
+  val invalidExc = Bool()
+  val infiniteExc = Bool()
+}
+
+// Divides or square-roots a whole element group per cycle with a radix-2
+// restoring recurrence unrolled across the pipeline. Each 64-bit lane
+// holds one FP64, two FP32 or four FP16 operands, and one recurrence
+// array serves all three formats by cutting its carry chain at element
+// boundaries. Stage 0 unpacks, the middle stages each retire
+// itersPerStage quotient or root bits, and the last stage rounds.
+// Narrower formats hold their state once they have all their bits.
+// Results and flags match FPDivSqrt.
+class SIMDFPDivSqrt(implicit p: Parameters) extends PipelinedFunctionalUnit(SIMDFPDivSqrtFactory.depth)(p) with HasFPUParameters {
+  val supported_insns = SIMDFPDivSqrtFactory.insns
+  val itersPerStage = SIMDFPDivSqrtFactory.itersPerStage
+
+  io.stall := false.B
+  io.set_vxsat := false.B
+
+  val fTypes = Seq(FType.H, FType.S, FType.D)
+  val nLanes = dLen / 64
+
+  def eewSel(op: ExecuteMicroOpWithData) = (1 to 3).map(_.U === op.vd_eew)
+  def isDiv(op: ExecuteMicroOpWithData) = op.opff6.isOneOf(OPFFunct6.fdiv, OPFFunct6.frdiv)
+
+  // Whether 16-bit chunk c of a lane is the lowest chunk of its element
+  def starts(sel: Seq[Bool]) = (0 until 4).map(c => Mux1H(sel, Seq(true.B, (c % 2 == 0).B, (c == 0).B)))
+
+  // Sets bit 0 of each element whose lowest chunk has b set
+  def atStarts(sel: Seq[Bool], bits: Seq[Bool]) = VecInit(starts(sel).zip(bits).map { case (s, b) => (s && b).asUInt.pad(16) }).asUInt
+
+  def perElem(sel: Seq[Bool], x: UInt)(f: (UInt, Int) => UInt) = Mux1H(sel, fTypes.map { ft =>
+    val w = ft.ieeeWidth
+    VecInit(x.asTypeOf(Vec(64 / w, UInt(w.W))).map(e => f(e, w).pad(w))).asUInt
+  })
+
+  // Subtracts b from a in each element of a lane. Also returns, for each
+  // chunk, whether the difference of its element is negative
+  def partitionedSub(sel: Seq[Bool], a: UInt, b: UInt): (UInt, Seq[Bool]) = {
+    val start = starts(sel)
+    val diff = Wire(Vec(4, UInt(16.W)))
+    var carry = true.B
+    for (c <- 0 until 4) {
+      val sum = a(16*c+15,16*c) +& ~b(16*c+15,16*c) +& Mux(start(c), true.B, carry)
+      diff(c) := sum(15,0)
+      carry = sum(16)
+    }
+    val neg = (0 until 4).map(c => Mux1H(sel, Seq(diff(c)(15), diff(c | 1)(15), diff(3)(15))))
+    (diff.asUInt, neg)
+  }
+
+  // One recurrence step. For division, aux holds the divisor. For square
+  // root, aux holds the radicand bits not yet consumed, which enter rem two
+  // at a time, and the trial subtrahend is 4*root+1.
+  // Significands are normalized, so rem and root never outgrow their
+  // element and whole-lane shifts do not leak between elements.
+  def step(sel: Seq[Bool], div: Bool, first: Boolean, rem: UInt, root: UInt, aux: UInt): (UInt, UInt, UInt) = {
+    val radicand = perElem(sel, aux)((e, w) => e(w-1,w-2))
+    val div_rem = if (first) rem else (rem << 1)(63,0)
+    val sqrt_rem = (rem << 2)(63,0) | radicand
+    val shifted = Mux(div, div_rem, sqrt_rem)
+    val trial = Mux(div, aux, (root << 2)(63,0) | atStarts(sel, Seq.fill(4)(true.B)))
+    val (diff, neg) = partitionedSub(sel, shifted, trial)
+    val next_rem = VecInit((0 until 4).map(c => Mux(neg(c), shifted(16*c+15,16*c), diff(16*c+15,16*c)))).asUInt
+    val next_root = (root << 1)(63,0) | atStarts(sel, neg.map(!_))
+    val next_aux = Mux(div, aux, perElem(sel, aux)((e, w) => e(w-3,0) ## 0.U(2.W)))
+    (next_rem, next_root, next_aux)
+  }
+
+  // Unpack
+  val in = io.pipe(0).bits
+  val in_sel = eewSel(in)
+  val in_div = isDiv(in)
+  val ctrl = new VectorDecoder(in, supported_insns, Seq(FPSwapVdV2))
+
+  val unpacked = fTypes.map { ft =>
+    val w = ft.ieeeWidth
+    val n = dLen / w
+    val rvs1 = in.rvs1_data.asTypeOf(Vec(n, UInt(w.W)))
+    val rvs2 = in.rvs2_data.asTypeOf(Vec(n, UInt(w.W)))
+    val elems = Seq.tabulate(n) { j =>
+      val recvs1 = ft.recode(rvs1(j))
+      val recvs2 = ft.recode(rvs2(j))
+      val a = hardfloat.rawFloatFromRecFN(ft.exp, ft.sig, Mux(ctrl.bool(FPSwapVdV2) && in_div, recvs1, recvs2))
+      val b = hardfloat.rawFloatFromRecFN(ft.exp, ft.sig, Mux(ctrl.bool(FPSwapVdV2) || !in_div, recvs2, recvs1))
+
+      // A zero divisor would let rem grow without bound, so divide by 1
+      // instead and let the special-case flags pick the result
+      val a_sig = a.sig(ft.sig-1,0)
+      val b_sig = 1.U(1.W) ## b.sig(ft.sig-2,0)
+      val radicand = Mux(a.sExp(0), a_sig ## 0.U(1.W), 0.U(1.W) ## a_sig) << (w - ft.sig - 1)
+
+      // Results are rounded from 2x the quotient or root, with a bias of
+      // 2^(exp+1)
+      val div_exp = (a.sExp -& b.sExp) +& ((BigInt(1) << (ft.exp + 1)) - 1).S
+      val sqrt_exp = (a.sExp >> 1) +& ((BigInt(1) << (ft.exp + 1)) - (BigInt(1) << (ft.exp - 1)) - 1).S
+
+      val meta = Wire(new SIMDFPDivSqrtMeta)
+      meta.sign := Mux(in_div, a.sign ^ b.sign, a.sign)
+      meta.sExp := Mux(in_div, div_exp, sqrt_exp)
+      meta.isNaN := a.isNaN || (in_div && b.isNaN)
+      meta.isInf := a.isInf
+      meta.isZero := a.isZero || (in_div && b.isInf)
+      meta.invalidExc := Mux(in_div,
+        hardfloat.isSigNaNRawFloat(a) || hardfloat.isSigNaNRawFloat(b) || (a.isInf && b.isInf) || (a.isZero && b.isZero),
+        hardfloat.isSigNaNRawFloat(a) || (!a.isNaN && !a.isZero && a.sign))
+      meta.infiniteExc := in_div && !a.isNaN && !a.isInf && !a.isZero && b.isZero
+      (Mux(in_div, a_sig, 0.U).pad(w), Mux(in_div, b_sig, radicand).pad(w), meta)
+    }
+    val lanes = elems.grouped(64 / w).toSeq
+    (lanes.map(l => VecInit(l.map(_._1)).asUInt), lanes.map(l => VecInit(l.map(_._2)).asUInt), elems.map(_._3))
+  }
+
+  // Per-element state is kept in 16-bit slots, one per FP16 element
+  val slot_meta = VecInit((0 until dLen / 16).map { s =>
+    Mux1H(fTypes.zip(unpacked).zip(in_sel).collect {
+      case ((ft, u), sel) if s % (ft.ieeeWidth / 16) == 0 => sel -> u._3(s / (ft.ieeeWidth / 16))
+    })
+  })
+
+  // Recurrence
+  var rem = (0 until nLanes).map(l => RegNext(Mux1H(in_sel, unpacked.map(_._1(l)))))
+  var aux = (0 until nLanes).map(l => RegNext(Mux1H(in_sel, unpacked.map(_._2(l)))))
+  var root = Seq.fill(nLanes)(0.U(64.W))
+  for (s <- 1 to depth - 2) {
+    val sel = eewSel(io.pipe(s).bits)
+    val div = isDiv(io.pipe(s).bits)
+    for (k <- 0 until itersPerStage) {
+      val i = (s - 1) * itersPerStage + k
+      if (i < FType.D.sig + 2) {
+        val en = Mux1H(sel, fTypes.map(ft => Mux(div, (i < ft.sig + 2).B, (i < ft.sig + 1).B)))
+        val next = (0 until nLanes).map(l => step(sel, div, i == 0, rem(l), root(l), aux(l)))
+        rem = rem.zip(next).map { case (r, n) => Mux(en, n._1, r) }
+        root = root.zip(next).map { case (r, n) => Mux(en, n._2, r) }
+        aux = aux.zip(next).map { case (a, n) => Mux(en, n._3, a) }
+      }
+    }
+    rem = rem.map(r => RegNext(r))
+    root = root.map(r => RegNext(r))
+    aux = aux.map(a => RegNext(a))
+  }
+
+  // Round
+  val out_op = io.pipe(depth-1).bits
+  val out_sel = eewSel(out_op)
+  val out_div = isDiv(out_op)
+  val out_meta = ShiftRegister(slot_meta, depth - 1)
+
+  val results = fTypes.map { ft =>
+    val w = ft.ieeeWidth
+    val n = dLen / w
+    val rems = VecInit(rem).asUInt.asTypeOf(Vec(n, UInt(w.W)))
+    val roots = VecInit(root).asUInt.asTypeOf(Vec(n, UInt(w.W)))
+    val outs = Seq.tabulate(n) { j =>
+      val m = out_meta(j * w / 16)
+      val round = Module(new hardfloat.RoundAnyRawFNToRecFN(ft.exp + 1, ft.sig + 2, ft.exp, ft.sig, 0))
+      round.io.invalidExc := m.invalidExc
+      round.io.infiniteExc := m.infiniteExc
+      round.io.in.isNaN := m.isNaN
+      round.io.in.isInf := m.isInf
+      round.io.in.isZero := m.isZero
+      round.io.in.sign := m.sign
+      round.io.in.sExp := m.sExp(ft.exp + 2, 0).asSInt
+      round.io.in.sig := Mux(out_div, roots(j)(ft.sig+1,0), roots(j)(ft.sig,0) ## 0.U(1.W)) ## rems(j).orR
+      round.io.roundingMode := out_op.frm
+      round.io.detectTininess := hardfloat.consts.tininess_afterRounding
+      (ft.ieee(round.io.out), Mux(out_op.wmask(j * w / 8), round.io.exceptionFlags, 0.U))
+    }
+    (VecInit(outs.map(_._1)).asUInt, outs.map(_._2).reduce(_|_))
+  }
+
+  io.write.valid := io.pipe(depth-1).valid
+  io.write.bits.eg := out_op.wvd_eg
+  io.write.bits.mask := FillInterleaved(8, out_op.wmask)
+  io.write.bits.data := Mux1H(out_sel, results.map(_._1))
+
+  io.set_fflags.valid := io.write.valid
+  io.set_fflags.bits := Mux1H(out_sel, results.map(_._2))
+
+  io.scalar_write.valid := false.B
+  io.scalar_write.bits := DontCare
+}
@@ -261,6 +261,7 @@ class TandemFMAPipe(depth: Int, buildFP64: Boolean, mxFPFMA: Boolean)(implicit p
 
 trait FMAFactory extends FunctionalUnitFactory {
   def depth: Int
+  def treeReduction: Boolean
   def base_insns = Seq(
     FADD.VV, FADD.VF, FSUB.VV, FSUB.VF, FRSUB.VF,
     FMUL.VV, FMUL.VF,
@@ -275,9 +276,10 @@ trait FMAFactory extends FunctionalUnitFactory {
     FWMSAC.VV, FWMSAC.VF, FWNMSAC.VV, FWNMSAC.VF,
     FREDOSUM.VV, FREDUSUM.VV, FWREDOSUM.VV, FWREDUSUM.VV
   ).map(_.pipelined(depth)).map(_.restrictSEW(0,1,2,3)).flatten
+    .filterNot(insn => treeReduction && FPReduceTreeFactory.claims(insn))
 }
 
-case class SIMDFPFMAFactory(depth: Int, elementWiseFP64: Boolean = false, mxFPFMA: Boolean) extends FMAFactory {
+case class SIMDFPFMAFactory(depth: Int, elementWiseFP64: Boolean = false, mxFPFMA: Boolean, treeReduction: Boolean = false) extends FMAFactory {
   def insns = if (elementWiseFP64) {
     base_insns.map { insn =>
       if (insn.lookup(SEW).value == 3 || (insn.lookup(SEW).value == 2 && insn.lookup(Wide2VD).value == 1)) {
@@ -289,11 +291,11 @@ case class SIMDFPFMAFactory(depth: Int, elementWiseFP64: Boolean = false, mxFPFM
   } else {
     base_insns
   }
-  def generate(implicit p: Parameters) = new FPFMAPipe(depth, elementWiseFP64, mxFPFMA)(p)
+  def generate(implicit p: Parameters) = new FPFMAPipe(depth, elementWiseFP64, mxFPFMA, treeReduction)(p)
 }
 
-class FPFMAPipe(depth: Int, elementwiseFP64: Boolean, mxFPFMA: Boolean)(implicit p: Parameters) extends PipelinedFunctionalUnit(depth)(p) with HasFPUParameters {
-  val supported_insns = SIMDFPFMAFactory(depth, elementwiseFP64, mxFPFMA).insns
+class FPFMAPipe(depth: Int, elementwiseFP64: Boolean, mxFPFMA: Boolean, treeReduction: Boolean)(implicit p: Parameters) extends PipelinedFunctionalUnit(depth)(p) with HasFPUParameters {
+  val supported_insns = SIMDFPFMAFactory(depth, elementwiseFP64, mxFPFMA, treeReduction).insns
 
   io.stall := false.B
   io.set_vxsat := false.B
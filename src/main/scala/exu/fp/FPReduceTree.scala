@@ -0,0 +1,144 @@
+package saturn.exu
+
+import chisel3._
+import chisel3.util._
+import org.chipsalliance.cde.config._
+import freechips.rocketchip.rocket._
+import freechips.rocketchip.util._
+import freechips.rocketchip.tile._
+import saturn.common._
+import saturn.insns._
+
+object FPReduceTreeFactory {
+  // The FMA pipe keeps the unordered reductions the tree does not claim
+  def claims(insn: VectorInstruction) = {
+    val f6 = insn.lookup(F6).value
+    val sew = insn.lookup(SEW).value
+    (f6 == OPFFunct6.fredusum.litValue && sew >= 2) || (f6 == OPFFunct6.fwredusum.litValue && sew == 2)
+  }
+}
+
+case class FPReduceTreeFactory(dLen: Int) extends FunctionalUnitFactory {
+  def levels = log2Ceil(dLen / 32)
+  def depth = levels + 2
+
+  def insns = (
+    FREDUSUM.VV.restrictSEW(2,3) ++
+    FWREDUSUM.VV.restrictSEW(2)
+  ).map(_.append(TreeReduction.Y).pipelined(depth))
+
+  def generate(implicit p: Parameters) = new FPReduceTree(dLen)(p)
+}
+
+// Unordered FP32/FP64 sums. Each element group is summed by an adder
+// tree, one tree level per stage, and the group sums are accumulated in
+// the stage after the root. The sequencer only hands over vs1[0] with
+// the last element group, which is added in the final stage.
+// Inactive elements enter the tree as the additive identity, which is -0
+// except under RDN, where +0 + -0 = -0 and +0 is the identity instead.
+// If no element is active, vs1[0] is returned unchanged and no flags are
+// raised.
+class FPReduceTree(dLen: Int)(implicit p: Parameters) extends PipelinedFunctionalUnit(FPReduceTreeFactory(dLen).depth)(p) with HasFPUParameters {
+  val supported_insns = FPReduceTreeFactory(dLen).insns
+  val levels = FPReduceTreeFactory(dLen).levels
+
+  io.stall := false.B
+  io.set_vxsat := false.B
+
+  def add(ft: FType, a: UInt, b: UInt, rm: UInt): (UInt, UInt) = {
+    val adder = Module(new hardfloat.AddRecFN(ft.exp, ft.sig))
+    adder.io.subOp := false.B
+    adder.io.a := a
+    adder.io.b := b
+    adder.io.roundingMode := rm
+    adder.io.detectTininess := hardfloat.consts.tininess_afterRounding
+    (adder.io.out, adder.io.exceptionFlags)
+  }
+
+  // Returns the group sum, its flags, and whether any leaf was active
+  def tree(ft: FType, leaves: Seq[UInt], leaf_exc: UInt, leaf_any: Bool): (UInt, UInt, Bool) = {
+    var level = leaves
+    var exc = leaf_exc
+    var any = leaf_any
+    for (l <- 0 until levels) {
+      val (sums, flags) = if (level.size > 1) {
+        level.grouped(2).map { case Seq(a, b) => add(ft, a, b, io.pipe(l).bits.frm) }.toSeq.unzip
+      } else {
+        (level, Nil)
+      }
+      level = sums.map(s => RegNext(s))
+      exc = RegNext(flags.foldLeft(exc)(_|_))
+      any = RegNext(any)
+    }
+    (level.head, exc, any)
+  }
+
+  val in = io.pipe(0).bits
+  val widen = in.rvs2_eew =/= in.vd_eew
+  val rdn = in.frm === hardfloat.consts.round_min
+  val zero_d = FType.D.recode(Mux(rdn, 0.U, "h8000000000000000".U))
+  val zero_s = FType.S.recode(Mux(rdn, 0.U, "h80000000".U))
+
+  // FP64 leaves, either vs2 elements or widened FP32 elements from the
+  // half of vs2 this element group covers
+  val nD = dLen / 64
+  val half = (in.eidx >> log2Ceil(nD))(0)
+  val rvs2_d = in.rvs2_data.asTypeOf(Vec(nD, UInt(64.W)))
+  val rvs2_s = in.rvs2_data.asTypeOf(Vec(2 * nD, UInt(32.W)))
+  val d_leaves = Seq.tabulate(nD) { i =>
+    val cvt = Module(new hardfloat.RecFNToRecFN(FType.S.exp, FType.S.sig, FType.D.exp, FType.D.sig))
+    cvt.io.in := FType.S.recode(Mux(half, rvs2_s(nD + i), rvs2_s(i)))
+    cvt.io.roundingMode := in.frm
+    cvt.io.detectTininess := hardfloat.consts.tininess_afterRounding
+    val active = in.wmask(i * 8)
+    val leaf = Mux(active, Mux(widen, cvt.io.out, FType.D.recode(rvs2_d(i))), zero_d)
+    (leaf, Mux(active && widen, cvt.io.exceptionFlags, 0.U), active)
+  }
+  val (d_root, d_exc, d_any) = tree(FType.D, d_leaves.map(_._1), d_leaves.map(_._2).reduce(_|_), d_leaves.map(_._3).orR)
+
+  val nS = dLen / 32
+  val s_active = Seq.tabulate(nS)(i => in.wmask(i * 4))
+  val s_leaves = in.rvs2_data.asTypeOf(Vec(nS, UInt(32.W))).zip(s_active).map { case (e, a) =>
+    Mux(a, FType.S.recode(e), zero_s)
+  }
+  val (s_root, s_exc, s_any) = tree(FType.S, s_leaves, 0.U, s_active.orR)
+
+  // Accumulate the element group sums
+  val acc_op = io.pipe(levels).bits
+  val acc_d = Reg(UInt(65.W))
+  val acc_s = Reg(UInt(33.W))
+  val acc_exc = Reg(UInt(5.W))
+  val acc_any = Reg(Bool())
+  val (d_sum, d_sum_exc) = add(FType.D, acc_d, d_root, acc_op.frm)
+  val (s_sum, s_sum_exc) = add(FType.S, acc_s, s_root, acc_op.frm)
+  val acc_is_d = acc_op.vd_eew === 3.U
+  when (io.pipe(levels).valid) {
+    when (acc_is_d) {
+      acc_d := Mux(acc_op.head, d_root, d_sum)
+    } .otherwise {
+      acc_s := Mux(acc_op.head, s_root, s_sum)
+    }
+    acc_any := Mux(acc_op.head, false.B, acc_any) || Mux(acc_is_d, d_any, s_any)
+    acc_exc := Mux(acc_op.head, 0.U, acc_exc) | Mux(acc_is_d,
+      d_exc | Mux(acc_op.head, 0.U, d_sum_exc),
+      s_exc | Mux(acc_op.head, 0.U, s_sum_exc))
+  }
+
+  // Add vs1[0], which arrives with the tail in rvs1_data
+  val out_op = io.pipe(depth-1).bits
+  val (d_out, d_out_exc) = add(FType.D, FType.D.recode(out_op.rvs1_data(63,0)), acc_d, out_op.frm)
+  val (s_out, s_out_exc) = add(FType.S, FType.S.recode(out_op.rvs1_data(31,0)), acc_s, out_op.frm)
+  val out_is_d = out_op.vd_eew === 3.U
+
+  io.write.valid := io.pipe(depth-1).valid && out_op.tail
+  io.write.bits.eg := out_op.wvd_eg
+  io.write.bits.mask := eewBitMask(out_op.vd_eew)
+  io.write.bits.data := Mux(!acc_any, out_op.rvs1_data(63,0),
+    Mux(out_is_d, FType.D.ieee(d_out), FType.S.ieee(s_out)))
+
+  io.set_fflags.valid := io.write.valid
+  io.set_fflags.bits := Mux(acc_any, acc_exc | Mux(out_is_d, d_out_exc, s_out_exc), 0.U)
+
+  io.scalar_write.valid := false.B
+  io.scalar_write.bits := DontCare
+}
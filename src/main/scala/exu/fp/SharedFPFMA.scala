@@ -9,9 +9,9 @@ import freechips.rocketchip.tile._
 import saturn.common._
 import saturn.insns._
 
-case class SharedScalarFPFMAFactory(depth: Int) extends FMAFactory {
+case class SharedScalarFPFMAFactory(depth: Int, treeReduction: Boolean = false) extends FMAFactory {
   def insns = base_insns.map(_.elementWise)
-  def generate(implicit p: Parameters) = new SharedScalarElementwiseFPFMA(depth)
+  def generate(implicit p: Parameters) = new SharedScalarElementwiseFPFMA(depth, treeReduction)
 }
 
 trait HasSharedFPUIO {
@@ -21,11 +21,11 @@ trait HasSharedFPUIO {
   val io_fp_resp = IO(Flipped(Valid(new FPResult())))
 }
 
-class SharedScalarElementwiseFPFMA(depth: Int)(implicit p: Parameters) extends PipelinedFunctionalUnit(depth)(p)
+class SharedScalarElementwiseFPFMA(depth: Int, treeReduction: Boolean)(implicit p: Parameters) extends PipelinedFunctionalUnit(depth)(p)
     with HasFPUParameters
     with HasSharedFPUIO {
 
-  val supported_insns = SharedScalarFPFMAFactory(depth).insns
+  val supported_insns = SharedScalarFPFMAFactory(depth, treeReduction).insns
 
   val ctrl = new VectorDecoder(io.pipe(0).bits, supported_insns, Seq(
     FPAdd, FPMul, FPSwapVdV2, FPFMACmd, ReadsVD, FPSpecRM, Wide2VD, Wide2VS2, Reduction))
@@ -0,0 +1,39 @@
+package saturn.exu
+
+import chisel3._
+import chisel3.util._
+import freechips.rocketchip.tile._
+import hardfloat._
+
+// Exact product of two FP8 values (E4M3 or E5M2, selected by altfmt)
+// as an FP32 RawFloat. The 4x4-bit significand product and the product
+// exponent range both fit in FP32, so no rounding is needed.
+object fp8ExactMul {
+
+	def apply(a: Bits, b: Bits, altfmt: Bool): RawFloat = {
+		val rawA = rawFloatFromFN(FType.E5M3.exp, FType.E5M3.sig, fp8ToE5M3(a, altfmt))
+		val rawB = rawFloatFromFN(FType.E5M3.exp, FType.E5M3.sig, fp8ToE5M3(b, altfmt))
+
+		val sigProd = rawA.sig(FType.E5M3.sig-1, 0) * rawB.sig(FType.E5M3.sig-1, 0)
+		val norm = sigProd(2*FType.E5M3.sig-1) // product in [2, 4)
+
+		val isNaN = rawA.isNaN || rawB.isNaN || (rawA.isInf && rawB.isZero) || (rawA.isZero && rawB.isInf)
+		val isZero = rawA.isZero || rawB.isZero
+
+		// RawFloat exponents are biased by 2^expWidth
+		val expOffset = ((1 << FType.S.exp) - (2 << FType.E5M3.exp)).U
+		val sExp = rawA.sExp.asUInt +& rawB.sExp.asUInt +& expOffset +& norm
+
+		val out = Wire(new RawFloat(FType.S.exp, FType.S.sig))
+		out.isNaN := isNaN
+		out.isInf := (rawA.isInf || rawB.isInf) && !isNaN
+		out.isZero := isZero && !isNaN
+		out.sign := rawA.sign ^ rawB.sign
+		out.sExp := Mux(isZero, 0.U, sExp(FType.S.exp, 0)).zext
+		out.sig := Mux(norm,
+			sigProd << (FType.S.sig - 2*FType.E5M3.sig),
+			sigProd << (FType.S.sig - 2*FType.E5M3.sig + 1)
+		)
+		out
+	}
+}
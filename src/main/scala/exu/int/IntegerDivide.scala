@@ -10,7 +10,8 @@ import freechips.rocketchip.tile._
 import saturn.common._
 import saturn.insns._
 
-case class IntegerDivideFactory(supportsMul: Boolean) extends FunctionalUnitFactory {
+// With simdDiv, e8/e16/e32 divides are left to SIMDIntegerDivider
+case class IntegerDivideFactory(supportsMul: Boolean, simdDiv: Boolean = false) extends FunctionalUnitFactory {
   def wideningMulInsns = Seq(
     WMUL.VV, WMUL.VX, WMULU.VV, WMULU.VX,
     WMULSU.VV, WMULSU.VX,
@@ -27,21 +28,23 @@ case class IntegerDivideFactory(supportsMul: Boolean) extends FunctionalUnitFact
     SMUL.VV, SMUL.VX
   )).map(_.elementWise)
 
-  def divInsns = Seq(
+  def baseDivInsns = Seq(
     DIVU.VV, DIVU.VX,
     DIV.VV, DIV.VX,
     REMU.VV, REMU.VX,
     REM.VV, REM.VX
-  ).map(_.elementWise)
+  )
+
+  def divInsns = (if (simdDiv) baseDivInsns.map(_.restrictSEW(3)).flatten else baseDivInsns).map(_.elementWise)
 
   def insns = (divInsns ++ (if (supportsMul) mulInsns else Nil)).map(_.iterative)
 
-  def generate(implicit p: Parameters) = new IterativeIntegerDivider(supportsMul)(p)
+  def generate(implicit p: Parameters) = new IterativeIntegerDivider(supportsMul, simdDiv)(p)
 }
 
-class IterativeIntegerDivider(supportsMul: Boolean)(implicit p: Parameters) extends IterativeFunctionalUnit()(p) {
-  val div_insns = IntegerDivideFactory(supportsMul).divInsns
-  val mul_insns = IntegerDivideFactory(supportsMul).mulInsns
+class IterativeIntegerDivider(supportsMul: Boolean, simdDiv: Boolean)(implicit p: Parameters) extends IterativeFunctionalUnit()(p) {
+  val div_insns = IntegerDivideFactory(supportsMul, simdDiv).divInsns
+  val mul_insns = IntegerDivideFactory(supportsMul, simdDiv).mulInsns
 
   val div = Module(new MulDiv(MulDivParams(mulUnroll = if (supportsMul) 8 else 0), 64, 1)) // 128 to make smul work
   io.stall := !div.io.req.ready || (valid && !last)
@@ -50,22 +53,24 @@ class IterativeIntegerDivider(supportsMul: Boolean)(implicit p: Parameters) exte
   io.set_fflags.valid := false.B
   io.set_fflags.bits := DontCare
 
-  div.io.req.valid := io.iss.valid
+  // SRAM VRF banks return the operands the cycle after issue
+  val (req_valid, req_op) = if (vParams.vrfSRAM) (RegNext(io.iss.valid, false.B), op) else (io.iss.valid, io.iss.op)
+  div.io.req.valid := req_valid
 
-  val ctrl_fn = WireInit(VecInit(Seq(FN_DIVU, FN_DIV, FN_REMU, FN_REM))(io.iss.op.funct6(1,0)))
-  val ctrl_sign1 = WireInit(io.iss.op.funct6(0))
-  val ctrl_sign2 = WireInit(io.iss.op.funct6(0))
+  val ctrl_fn = WireInit(VecInit(Seq(FN_DIVU, FN_DIV, FN_REMU, FN_REM))(req_op.funct6(1,0)))
+  val ctrl_sign1 = WireInit(req_op.funct6(0))
+  val ctrl_sign2 = WireInit(req_op.funct6(0))
   val ctrl_swapvdv2 = WireInit(false.B)
 
   if (supportsMul) {
-    val mul_ctrl = new VectorDecoder(io.iss.op, mul_insns, Seq(
+    val mul_ctrl = new VectorDecoder(req_op, mul_insns, Seq(
       MULHi, MULSign1, MULSign2, MULSwapVdV2))
     when (mul_ctrl.matched) {
       ctrl_fn       := Mux(mul_ctrl.bool(MULHi),
         Mux(mul_ctrl.bool(MULSign2) && mul_ctrl.bool(MULSign1), FN_MULH,
           Mux(mul_ctrl.bool(MULSign2), FN_MULHSU, FN_MULHU)),
         FN_MUL)
-      when (io.iss.op.isOpi) { ctrl_fn := FN_MULH }
+      when (req_op.isOpi) { ctrl_fn := FN_MULH }
       ctrl_sign1    := mul_ctrl.bool(MULSign1)
       ctrl_sign2    := mul_ctrl.bool(MULSign2)
       ctrl_swapvdv2 := mul_ctrl.bool(MULSwapVdV2)
@@ -73,12 +78,12 @@ class IterativeIntegerDivider(supportsMul: Boolean)(implicit p: Parameters) exte
   }
 
   div.io.req.bits.fn := ctrl_fn
-  div.io.req.bits.in1 := Mux(ctrl_swapvdv2, io.iss.op.rvd_elem, Mux(ctrl_sign2,
-    sextElem(io.iss.op.rvs2_elem, io.iss.op.rvs2_eew),
-    io.iss.op.rvs2_elem))
+  div.io.req.bits.in1 := Mux(ctrl_swapvdv2, req_op.rvd_elem, Mux(ctrl_sign2,
+    sextElem(req_op.rvs2_elem, req_op.rvs2_eew),
+    req_op.rvs2_elem))
   div.io.req.bits.in2 := Mux(ctrl_sign1,
-    sextElem(io.iss.op.rvs1_elem, io.iss.op.rvs1_eew),
-    io.iss.op.rvs1_elem)
+    sextElem(req_op.rvs1_elem, req_op.rvs1_eew),
+    req_op.rvs1_elem)
   div.io.req.bits.dw  := DW_64
   div.io.req.bits.tag := DontCare
 
@@ -133,3 +138,130 @@ class IterativeIntegerDivider(supportsMul: Boolean)(implicit p: Parameters) exte
   io.acc := false.B
   io.tail := false.B
 }
+
+case object SIMDIntegerDivideFactory extends FunctionalUnitFactory {
+  def insns = IntegerDivideFactory(false).baseDivInsns.map(_.restrictSEW(0, 1, 2)).flatten.map(_.iterative)
+
+  def generate(implicit p: Parameters) = new SIMDIntegerDivider()(p)
+}
+
+// Divides a whole element group at once. Each 64b chunk holds the same
+// mix of widths as a MultiplyBlock: two 32b, two 16b and four 8b
+// dividers, each at a fixed bit offset, so at e8 all eight are busy and
+// at e32 only the two 32b ones. Every divider retires 2 quotient bits
+// a cycle, so an element group takes (8 << eew) / 2 cycles.
+class SIMDIntegerDivider(implicit p: Parameters) extends IterativeFunctionalUnit()(p) {
+  val supported_insns = SIMDIntegerDivideFactory.insns
+
+  io.set_vxsat := false.B
+  io.set_fflags.valid := false.B
+  io.set_fflags.bits := DontCare
+
+  // SRAM VRF banks return the operands the cycle after issue
+  val (start, start_op) = if (vParams.vrfSRAM) (RegNext(io.iss.valid, false.B), op) else (io.iss.valid, io.iss.op)
+  val iss_signed = start_op.funct6(0)
+  val iss_rem = start_op.funct6(1)
+  val iss_eew = start_op.rvd_eew
+
+  val count = RegInit(0.U(5.W))
+  when (start) {
+    count := (4.U << iss_eew)
+  } .elsewhen (count =/= 0.U) {
+    count := count - 1.U
+  }
+
+  val slots = Seq(32 -> Seq(0, 32), 16 -> Seq(16, 48), 8 -> Seq(8, 24, 40, 56))
+  val dividers = Seq.tabulate(dLen / 64) { c =>
+    slots.map { case (w, offs) => offs.map { o =>
+      val div = Module(new DivideBlock(w))
+      div.io.start := start
+      div.io.step := count =/= 0.U
+      div.io.eew := iss_eew
+      div.io.signed := iss_signed
+      div.io.rem := iss_rem
+      div.io.in1 := start_op.rvs1_data(64 * c + o + w - 1, 64 * c + o)
+      div.io.in2 := start_op.rvs2_data(64 * c + o + w - 1, 64 * c + o)
+      (64 * c + o) -> div.io.out
+    }}.flatten
+  }.flatten.toMap
+
+  val wdata = VecInit.tabulate(3)({ eew =>
+    VecInit.tabulate(dLen >> (3 + eew))({ i => dividers(i << (3 + eew))((8 << eew) - 1, 0) }).asUInt
+  } ++ Seq(0.U(dLen.W)))(op.rvd_eew)
+
+  io.hazard.valid       := valid
+  io.hazard.bits.eg     := op.wvd_eg
+  io.hazard.bits.vat    := op.vat
+
+  io.write.valid     := valid && count === 0.U && !(start && vParams.vrfSRAM.B)
+  io.write.bits.eg   := op.wvd_eg
+  io.write.bits.mask := FillInterleaved(8, op.wmask)
+  io.write.bits.data := wdata
+  io.stall := valid && !last
+
+  io.scalar_write.valid := false.B
+  io.scalar_write.bits := DontCare
+
+  last := io.write.fire
+
+  io.acc := false.B
+  io.tail := false.B
+}
+
+// Radix-4 restoring divider for elements up to w bits wide, operating on
+// magnitudes. The dividend is left-aligned so an (8 << eew)-bit element
+// only needs (4 << eew) steps.
+class DivideBlock(w: Int) extends Module {
+  val io = IO(new Bundle {
+    val start = Input(Bool())
+    val step = Input(Bool())
+    val eew = Input(UInt(2.W))
+    val signed = Input(Bool())
+    val rem = Input(Bool())
+    val in1 = Input(UInt(w.W)) // divisor
+    val in2 = Input(UInt(w.W)) // dividend
+
+    val out = Output(UInt(w.W))
+  })
+
+  val eews = (0 until 3).filter(e => (8 << e) <= w)
+  def sel[T <: Data](f: Int => T): T = VecInit(eews.map(f))(io.eew)
+
+  val in1_neg = io.signed && sel(e => io.in1((8 << e) - 1))
+  val in2_neg = io.signed && sel(e => io.in2((8 << e) - 1))
+  val in1_mag = sel(e => Mux(in1_neg, -io.in1((8 << e) - 1, 0), io.in1((8 << e) - 1, 0)).pad(w))
+  val in2_mag = sel(e => Mux(in2_neg, -io.in2((8 << e) - 1, 0), io.in2((8 << e) - 1, 0)).pad(w))
+
+  val divisor = Reg(UInt(w.W))
+  val quot = Reg(UInt(w.W))
+  val rem = Reg(UInt((w + 1).W))
+  val neg_quot = Reg(Bool())
+  val neg_rem = Reg(Bool())
+  val out_rem = Reg(Bool())
+
+  def step(r: UInt, q: UInt): (UInt, UInt) = {
+    val shifted = Cat(r(w - 1, 0), q(w - 1))
+    val diff = shifted -& divisor
+    val fits = !diff(w + 1)
+    (Mux(fits, diff(w, 0), shifted), Cat(q(w - 2, 0), fits))
+  }
+
+  when (io.start) {
+    divisor := in1_mag
+    quot := sel(e => (in2_mag << (w - (8 << e)))(w - 1, 0))
+    rem := 0.U
+    // divide by zero returns all ones and the dividend, unsigned
+    neg_quot := in1_neg =/= in2_neg && in1_mag =/= 0.U
+    neg_rem := in2_neg
+    out_rem := io.rem
+  } .elsewhen (io.step) {
+    val (r1, q1) = step(rem, quot)
+    val (r2, q2) = step(r1, q1)
+    rem := r2
+    quot := q2
+  }
+
+  io.out := Mux(out_rem,
+    Mux(neg_rem, -rem(w - 1, 0), rem(w - 1, 0)),
+    Mux(neg_quot, -quot, quot))
+}
@@ -241,12 +241,19 @@ class IntegerPipe(implicit p: Parameters) extends PipelinedFunctionalUnit(2)(p)
   val in1_bytes = Mux(ctrl.bool(Swap12), rvs2_bytes, rvs1_bytes)
   val in2_bytes = Mux(ctrl.bool(Swap12), rvs1_bytes, rvs2_bytes)
 
-  val narrow_vs1 = RegEnable(narrow2_expand(iss_rvs1_bytes, io.iss.op.rvs1_eew,
-    (io.iss.op.eidx >> (dLenOffBits.U - io.iss.op.vd_eew))(0),
-    iss_ctrl.bool(WideningSext)), io.iss.valid)
-  val narrow_vs2 = RegEnable(narrow2_expand(iss_rvs2_bytes, io.iss.op.rvs2_eew,
-    (io.iss.op.eidx >> (dLenOffBits.U - io.iss.op.vd_eew))(0),
-    iss_ctrl.bool(WideningSext)), io.iss.valid)
+  // SRAM VRF banks only return the operands in stage 0
+  val (narrow_vs1, narrow_vs2) = if (vParams.vrfSRAM) {
+    val upper = (io.pipe(0).bits.eidx >> (dLenOffBits.U - io.pipe(0).bits.vd_eew))(0)
+    (narrow2_expand(rvs1_bytes, io.pipe(0).bits.rvs1_eew, upper, ctrl.bool(WideningSext)),
+      narrow2_expand(rvs2_bytes, io.pipe(0).bits.rvs2_eew, upper, ctrl.bool(WideningSext)))
+  } else {
+    (RegEnable(narrow2_expand(iss_rvs1_bytes, io.iss.op.rvs1_eew,
+      (io.iss.op.eidx >> (dLenOffBits.U - io.iss.op.vd_eew))(0),
+      iss_ctrl.bool(WideningSext)), io.iss.valid),
+    RegEnable(narrow2_expand(iss_rvs2_bytes, io.iss.op.rvs2_eew,
+      (io.iss.op.eidx >> (dLenOffBits.U - io.iss.op.vd_eew))(0),
+      iss_ctrl.bool(WideningSext)), io.iss.valid))
+  }
 
   val add_mask_carry = VecInit.tabulate(4)({ eew =>
     VecInit((0 until dLenB >> eew).map { i => io.pipe(0).bits.rmask(i) | 0.U((1 << eew).W) }).asUInt
@@ -22,6 +22,8 @@ class VectorDispatcher(implicit p: Parameters) extends CoreModule()(p) with HasV
     val vat_release = Input(Vec(nRelease, Valid(UInt(vParams.vatSz.W))))
     val vat_head = Output(UInt(vParams.vatSz.W))
     val vat_tail = Output(UInt(vParams.vatSz.W))
+
+    val vrf_home = Output(UInt((if (vParams.vrfRenaming) 32 else 0).W))
   })
 
   val debug_id_ctr = RegInit(0.U(debugIdSz.W))
@@ -106,10 +108,73 @@ class VectorDispatcher(implicit p: Parameters) extends CoreModule()(p) with HasV
     }
   }
 
+  // ======================================
+  // VRF renaming
+  //
+  // With vrfRenaming the VRF holds two copies of each vreg, and vrf_home
+  // selects the one holding the architectural value. An instruction that
+  // overwrites every element of its destination registers writes the other
+  // copy instead, so it never waits on older accesses to the current one.
+  // The copy it leaves is stale until every instruction up to it has
+  // released its vat, after which it can be renamed into again.
+
+  io.vrf_home := DontCare
+  if (vParams.vrfRenaming) {
+    val vrf_home = RegInit(0.U(32.W))
+    val stale = RegInit(VecInit.fill(32)(false.B))
+    val stale_vat = Reg(Vec(32, UInt(vParams.vatSz.W)))
+    def vatInFlight(vat: UInt) = Mux(vat_tail === vat_head,
+      vat_valids(vat_head),
+      (vat - vat_head) < (vat_tail - vat_head))
+    for (r <- 0 until 32) {
+      when (stale(r) && !vatInFlight(stale_vat(r))) { stale(r) := false.B }
+    }
+
+    val rn_insns = vParams.issStructure.generate(vParams).map(_.insns).flatten
+    val rn_ctrl = new VectorDecoder(issue_inst, rn_insns, Seq(
+      WritesVD, WritesScalar, WritesAsMask, Reduction, ScalarToVD0, Slide, Wide2VD))
+    val rn_arith = (!issue_inst.vmu && rn_ctrl.matched &&
+      rn_ctrl.bool(WritesVD) && !rn_ctrl.bool(WritesScalar) && !rn_ctrl.bool(WritesAsMask) &&
+      !rn_ctrl.bool(Reduction) && !rn_ctrl.bool(ScalarToVD0) && !rn_ctrl.bool(Slide) &&
+      issue_inst.opmf6 =/= OPMFunct6.compress &&
+      !(issue_inst.funct3 === OPIVI && issue_inst.opif6 === OPIFunct6.mvnrr))
+    val rn_load = (issue_inst.vmu && !issue_inst.store &&
+      !(issue_inst.orig_mop === mopUnit && issue_inst.umop.isOneOf(lumopMask, lumopFF)))
+    val rn_eew = Mux(issue_inst.vmu, issue_inst.mem_elem_size, issue_inst.sew)
+    // Every element of every destination register is written only if vl
+    // spans whole registers and nothing is masked off or skipped
+    val rn_full = (issue_inst.vm && issue_inst.vstart === 0.U && !issue_inst.fission_vl.valid &&
+      issue_inst.segstart === 0.U && issue_inst.segend === issue_inst.seg_nf &&
+      issue_inst.vconfig.vl === (((vLen/8).U >> rn_eew) << issue_inst.emul))
+
+    val rn_lmul = issue_inst.emul +& Mux(issue_inst.vmu, 0.U, rn_ctrl.bool(Wide2VD))
+    val rn_first = ((issue_inst.rd >> rn_lmul) << rn_lmul)(4,0)
+    val rn_count = Mux(issue_inst.vmu, (issue_inst.seg_nf +& 1.U) << issue_inst.emul, 1.U << rn_lmul)
+    // v0 is never renamed, as the VRF banks keep only one copy of the mask
+    // rows. A group containing v0 still renames its other registers
+    val rn_regs = VecInit.tabulate(32)(r => (r != 0).B && r.U >= rn_first && r.U < rn_first +& rn_count).asUInt
+    val rename = ((rn_arith || rn_load) && rn_full && rn_lmul <= 3.U && rn_first +& rn_count <= 32.U &&
+      (rn_regs & stale.asUInt) === 0.U)
+
+    io.vrf_home := vrf_home
+    issue_inst.rhome := vrf_home
+    issue_inst.whome := vrf_home ^ Mux(rename, rn_regs, 0.U)
+    when (io.dis.fire && rename) {
+      vrf_home := issue_inst.whome
+      for (r <- 0 until 32) {
+        when (rn_regs(r)) {
+          stale(r) := true.B
+          stale_vat(r) := vat_tail
+        }
+      }
+    }
+  }
+
   io.dis.bits := issue_inst
 
   io.mem.bits.base_offset := issue_inst.rs1_data
   io.mem.bits.stride := issue_inst.rs2_data
+  io.mem.bits.stride_x0 := issue_inst.rs2 === 0.U
   io.mem.bits.page := issue_inst.page
   io.mem.bits.vstart := issue_inst.vstart
   io.mem.bits.segstart := issue_inst.segstart
@@ -84,6 +84,8 @@ class PipelinedFaultCheck(edge: TLEdge, sgSize: Option[BigInt])(implicit p: Para
   s0_inst.page     := DontCare
   s0_inst.vat      := DontCare
   s0_inst.debug_id := DontCare
+  s0_inst.rhome    := DontCare
+  s0_inst.whome    := DontCare
   s0_inst.rm       := DontCare
   s0_inst.fast_sg  := false.B
   s0_inst.mop      := s0_inst.orig_mop
@@ -43,6 +43,7 @@ object AccInitZeros      extends NDefaultInstructionField
 object AccInitOnes       extends NDefaultInstructionField
 object AccInitPos        extends NDefaultInstructionField
 object AccInitNeg        extends NDefaultInstructionField
+object TreeReduction     extends NDefaultInstructionField
 
 // Integer Pipe control
 object Swap12            extends NDefaultInstructionField
@@ -234,6 +234,7 @@ object WSLL       extends OPIInstruction    { val props = Seq(F6(OPIFunct6.wsll)
 
 // Outer product instructions
 object OPMACC      extends OPMInstruction    { val props = Seq(F6(OPMFunct6.opmacc)     , ReadsVS1.Y, ReadsVS2.Y, WritesVD.N) }
+object OPMACCI     extends OPMInstruction    { val props = Seq(F6(OPMFunct6.opmacci)    , ReadsVS1.Y, ReadsVS2.Y, WritesVD.N) }
 object OPMVIN      extends OPMInstruction    { val props = Seq(F6(OPMFunct6.opmvin)     , ReadsVS1.N, ReadsVS2.Y, WritesVD.N) }
 object OPMVINBCAST extends OPMInstruction    { val props = Seq(F6(OPMFunct6.opmvinbcast), ReadsVS1.N, ReadsVS2.Y, WritesVD.N) }
 object OPMVOUT     extends OPMInstruction    { val props = Seq(F6(OPMFunct6.opmvout)    , ReadsVS1.N, ReadsVS2.N, WritesVD.Y) }
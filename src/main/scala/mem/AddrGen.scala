@@ -25,6 +25,10 @@ class AddrGen(implicit p: Parameters) extends CoreModule()(p) with HasVectorPara
       val ready = Output(Bool())
     }
     val req = Decoupled(new MemRequest(mLenB, dmemTagBits))
+    val fwd = Input(new Bundle {
+      val hit = Bool()   // req can be served from the store data buffer
+      val stall = Bool() // req overlaps an unacknowledged store it cannot forward from
+    })
 
     val out = Decoupled(new IFQEntry)
   })
@@ -79,28 +83,47 @@ class AddrGen(implicit p: Parameters) extends CoreModule()(p) with HasVectorPara
   val masked = (needs_mask && !io.maskindex.mask) || (io.op.seg_nf > 0.U && sidx > io.op.segend)
   val may_clear = (fast_segmented || next_sidx > io.op.seg_nf) && next_eidx >= max_eidx
 
+  // Strided/indexed loads that land in the block of the last request share
+  // its response instead of issuing another one. A zero stride from a
+  // register other than x0 must perform every access
+  val r_block = Reg(UInt((pgIdxBits-mLenOffBits).W))
+  val r_block_valid = RegInit(false.B)
+  val repeat_required = io.op.mop === mopStrided && io.op.stride === 0.U && !io.op.stride_x0
+  val coalesced = (vParams.coalesceLoads.B && !io.op.store && io.op.mop =/= mopUnit && !repeat_required &&
+    r_block_valid && saddr(pgIdxBits-1,mLenOffBits) === r_block)
+  val forwarded = io.fwd.hit && !masked && !coalesced
+  val fwd_stall = io.fwd.stall && !masked && !coalesced
+  val no_req = masked || coalesced || forwarded
 
   io.done := false.B
   io.maskindex.ready := false.B
   io.maskindex.needs_mask := needs_mask
   io.maskindex.needs_index := needs_index
   io.maskindex.eew := io.op.idx_size
-  io.out.valid := io.valid && !block_maskindex && (masked || io.req.ready) && io.tag.valid
+  io.out.valid := io.valid && !block_maskindex && !fwd_stall && (no_req || io.req.ready) && io.tag.valid
   io.out.bits.head := saddr
   io.out.bits.tail := saddr + next_act_bytes
   io.out.bits.masked := masked
+  io.out.bits.coalesced := coalesced && !masked
+  io.out.bits.forwarded := forwarded
   io.out.bits.last := may_clear
   io.out.bits.lsiq_id := io.lsiq_id
   io.out.bits.page_offset := saddr(pgIdxBits-1,0)
 
-  io.req.valid := io.valid && io.out.ready && !block_maskindex && !masked && io.tag.valid
+  io.req.valid := io.valid && io.out.ready && !block_maskindex && !fwd_stall && !no_req && io.tag.valid
   io.req.bits.addr := Cat(io.op.page, saddr(pgIdxBits-1,0))
   io.req.bits.data := DontCare
   io.req.bits.mask := ((1.U << next_act_bytes) - 1.U) << saddr(mLenOffBits-1,0)
   io.req.bits.tag := io.tag.bits
   io.req.bits.store := DontCare
+  io.req.bits.l1 := io.op.prefers_l1(vParams.l1StreamBytes)
 
-  io.tag.ready := io.valid && (io.req.ready || masked) && io.out.ready && !block_maskindex
+  io.tag.ready := io.valid && (io.req.ready || no_req) && io.out.ready && !block_maskindex && !fwd_stall
+
+  when (io.req.fire) {
+    r_block := saddr(pgIdxBits-1,mLenOffBits)
+    r_block_valid := true.B
+  }
 
   when (io.out.fire) {
     when (next_sidx > io.op.seg_nf || fast_segmented) {
@@ -119,6 +142,7 @@ class AddrGen(implicit p: Parameters) extends CoreModule()(p) with HasVectorPara
     when (may_clear) {
       io.done := true.B
       r_head := true.B
+      r_block_valid := false.B
     }
   }
 
@@ -27,6 +27,7 @@ class LoadOrderBuffer(nEntries: Int, nRobEntries: Int)(implicit p: Parameters) e
   val io = IO(new Bundle {
     val reserve = Decoupled(UInt(tagBits.W))
     val entry = Input(new IFQEntry)
+    val entry_data = Input(UInt(mLen.W)) // for forwarded entries
     val push = Input(Valid(new Bundle {
       val data = UInt(mLen.W)
       val tag = UInt(tagBits.W)
@@ -47,6 +48,10 @@ class LoadOrderBuffer(nEntries: Int, nRobEntries: Int)(implicit p: Parameters) e
   val rob_idxs = Reg(Vec(nEntries, UInt(log2Ceil(nRobEntries).W)))
   val rob = Reg(Vec(nRobEntries, UInt(mLen.W)))
   val rob_valids = RegInit(VecInit.fill(nRobEntries)(false.B))
+  val last_data = Reg(UInt(mLen.W))
+
+  // Forwarded entries dequeue in order, so their data waits in a queue of its own
+  val fwd_data = Option.when(vParams.forwardStores) { Module(new Queue(UInt(mLen.W), nEntries)) }
 
   val enq_ptr = Counter(nEntries)
   val deq_ptr = Counter(nEntries)
@@ -63,14 +68,22 @@ class LoadOrderBuffer(nEntries: Int, nRobEntries: Int)(implicit p: Parameters) e
   io.reserve.bits := enq_ptr.value
   when (io.reserve.fire) {
     entries(enq_ptr.value) := io.entry
-    valids(enq_ptr.value) := io.entry.masked
+    valids(enq_ptr.value) := io.entry.masked || io.entry.coalesced || io.entry.forwarded
     enq_ptr.inc()
   }
 
   io.deq.valid := !empty && (valids(deq_ptr.value) || (io.push.fire && io.push.bits.tag === deq_ptr.value))
   io.deq.bits := entries(deq_ptr.value)
   val rob_deq_idx = if (simpleRob) deq_ptr.value else rob_idxs(deq_ptr.value)
-  io.deq_data := Mux(valids(deq_ptr.value), rob(rob_deq_idx), io.push.bits.data)
+  io.deq_data := Mux(entries(deq_ptr.value).coalesced, last_data,
+    Mux(valids(deq_ptr.value), rob(rob_deq_idx), io.push.bits.data))
+  fwd_data.foreach { q =>
+    q.io.enq.valid := io.reserve.fire && io.entry.forwarded
+    q.io.enq.bits := io.entry_data
+    q.io.deq.ready := io.deq.fire && entries(deq_ptr.value).forwarded
+    when (entries(deq_ptr.value).forwarded) { io.deq_data := q.io.deq.bits }
+    when (q.io.enq.valid) { assert(q.io.enq.ready) }
+  }
 
   val rob_push_idx = if (simpleRob) io.push.bits.tag else rob_next
   when (io.push.valid && !(deq_ptr.value === io.push.bits.tag && io.deq.ready)) {
@@ -87,9 +100,13 @@ class LoadOrderBuffer(nEntries: Int, nRobEntries: Int)(implicit p: Parameters) e
   when (io.deq.fire) {
     deq_ptr.inc()
     valids(deq_ptr.value) := false.B
-    when (valids(deq_ptr.value) && !entries(deq_ptr.value).masked) {
+    val from_mem = !entries(deq_ptr.value).masked && !entries(deq_ptr.value).coalesced && !entries(deq_ptr.value).forwarded
+    when (valids(deq_ptr.value) && from_mem) {
       rob_valids(rob_deq_idx) := false.B
     }
+    when (from_mem) {
+      last_data := io.deq_data
+    }
   }
 
   val replay_valid = must_replay.orR
@@ -101,6 +118,7 @@ class LoadOrderBuffer(nEntries: Int, nRobEntries: Int)(implicit p: Parameters) e
   io.replay.bits.mask := ~(0.U(mLenB.W))
   io.replay.bits.tag  := next_replay
   io.replay.bits.store := false.B
+  io.replay.bits.l1 := DontCare
 
   when (io.replay.fire) {
     must_replay(next_replay) := false.B
@@ -10,7 +10,7 @@ import saturn.common._
 
 class LSIQEntry(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
   val op = new VectorMemMacroOp
-  def bound_all = op.mop =/= mopUnit
+  def bound_all = if (vParams.forwardStores) op.indexed else op.mop =/= mopUnit
   val bound_offset = UInt(pgIdxBits.W)
   val ld_dep_mask = Vec(vParams.vliqEntries, Bool())
   val st_dep_mask = Vec(vParams.vsiqEntries, Bool())
@@ -33,6 +33,8 @@ class IFQEntry(implicit p: Parameters) extends CoreBundle()(p) with HasVectorPar
   val head   = UInt(log2Ceil(mLenB).W)
   val tail   = UInt(log2Ceil(mLenB).W)
   val masked = Bool()
+  val coalesced = Bool() // reuses the response of the previous unmasked entry
+  val forwarded = Bool() // data comes from the store data buffer, not memory
   val last   = Bool()
   val lsiq_id  = UInt(lsiqIdBits.W)
   val page_offset = UInt(pgIdxBits.W)
@@ -44,6 +46,7 @@ class MemRequest(bytes: Int, tagBits: Int)(implicit p: Parameters) extends CoreB
   val mask = UInt(bytes.W)
   val tag = UInt(tagBits.W)
   val store = Bool()
+  val l1 = Bool() // prefers the scalar L1 port, where there is one
 }
 
 class MemResponse(bytes: Int, tagBits: Int)(implicit p: Parameters) extends CoreBundle()(p) {
@@ -105,11 +108,14 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
 
     val dmem = new VectorMemIO
     val sgmem = sgSize.map(_ => new VectorSGMemIO)
+    val prefetch = Option.when(vParams.prefetchLines > 0)(new VectorPrefetchIO)
     val scalar_check = new ScalarMemOrderCheckIO
 
     val vu = new VectorMemDatapathIO
 
     val busy = Output(Bool())
+
+    val perf = Output(new VectorMemPerf)
   })
 
   def ptrIncr(u: UInt, sz: Int): Unit = {
@@ -162,7 +168,12 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
   val siq_sss_valid = !siq_sss(siq_sss_ptr) && siq_valids(siq_sss_ptr)
   val siq_sas_valid = !siq_sas(siq_sas_ptr) && siq_valids(siq_sas_ptr)
 
-  val enq_bound_max = (((io.enq.bits.nf +& 1.U) * io.enq.bits.vl) << io.enq.bits.elem_size) + io.enq.bits.base_offset - 1.U
+  // With forwardStores, strided ops are bounded by their last segment.
+  // Negative strides wrap past the page and fall back to the whole page.
+  // Otherwise they conflict with the whole page.
+  val enq_unit_bound_max = (((io.enq.bits.nf +& 1.U) * io.enq.bits.vl) << io.enq.bits.elem_size) + io.enq.bits.base_offset - 1.U
+  val enq_strided_bound_max = ((io.enq.bits.vl - 1.U) * io.enq.bits.stride) + ((io.enq.bits.nf +& 1.U) << io.enq.bits.elem_size) + io.enq.bits.base_offset - 1.U
+  val enq_bound_max = Mux(vParams.forwardStores.B && io.enq.bits.mop === mopStrided && io.enq.bits.vl =/= 0.U, enq_strided_bound_max, enq_unit_bound_max)
   val enq_bound = Mux((enq_bound_max >> pgIdxBits) =/= 0.U, ~(0.U(pgIdxBits.W)), enq_bound_max)
 
   when (liq_enq_fire) {
@@ -271,9 +282,15 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
   sas.io.maskindex.valid := !maskindex_load && (io.vu.mask_pop.ready || !sas.io.maskindex.needs_mask) && (io.vu.index_pop.ready || !sas.io.maskindex.needs_index)
 
   // Load Addr Sequencing
+  // A unit-stride load may pass an overlapping older store once all of that store's
+  // requests have been sent. Until they are acknowledged, the store data buffer
+  // either forwards them or holds the overlapping load requests back.
+  val siq_reqs_pending = Wire(Vec(vParams.vsiqEntries, Bool()))
   val las_order_block = (0 until vParams.vsiqEntries).map { i =>
     val addr_conflict = siq(i).overlaps(liq(liq_las_ptr))
-    siq_valids(i) && addr_conflict && liq(liq_las_ptr).st_dep_mask(i)
+    val forwardable = (vParams.forwardStores.B && liq(liq_las_ptr).op.mop === mopUnit &&
+      siq_sas(i) && !siq(i).op.fast_sg && !siq_reqs_pending(i))
+    siq_valids(i) && addr_conflict && liq(liq_las_ptr).st_dep_mask(i) && !forwardable
   }.orR
   val dae_block = !vParams.enableDAE.B && (!io.vu.lresp.ready ||
     io.vu.lresp.bits.debug_id =/= liq(liq_las_ptr).op.debug_id)
@@ -286,6 +303,7 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
   las.io.tag <> lifq.io.reserve
   las.io.out.ready := lifq.io.reserve.valid
   lifq.io.entry := las.io.out.bits
+  lifq.io.entry_data := DontCare
 
   lifq.io.push.valid := io.dmem.load_resp.valid
   lifq.io.push.bits.data := io.dmem.load_resp.bits.data
@@ -296,6 +314,7 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
   load_arb.io.in(1).bits.store := false.B
   load_arb.io.in(0) <> lifq.io.replay
   load_arb.io.in(0).bits.addr := Cat(liq(lifq.io.replay_liq_id).op.page, lifq.io.replay.bits.addr(pgIdxBits-1,0))
+  load_arb.io.in(0).bits.l1 := liq(lifq.io.replay_liq_id).op.prefers_l1(vParams.l1StreamBytes)
   when (io.dmem.store_req.valid) {
     load_arb.io.in(0).valid := false.B
     lifq.io.replay.ready := false.B
@@ -340,6 +359,8 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
     liq_valids(i) && addr_conflict && siq(siq_sas_ptr).ld_dep_mask(i)
   }.orR
   sas.io.valid := siq_sas_valid && !sas_order_block && !siq(siq_sas_ptr).op.fast_sg
+  sas.io.fwd.hit := false.B
+  sas.io.fwd.stall := false.B
   sas.io.lsiq_id := siq_sas_ptr
   sas.io.op := siq(siq_sas_ptr).op
   siq_sas_fire := Mux(siq(siq_sas_ptr).op.fast_sg, sgas.map(_.io.done && maskindex_scatter).getOrElse(false.B), sas.io.done)
@@ -349,6 +370,10 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
     val request = new MemRequest(mLenB, dmemTagBits)
   }, 2))
 
+  for (i <- 0 until vParams.vsiqEntries) {
+    siq_reqs_pending(i) := store_req_q.io.peek.map(e => e.valid && e.bits.sifq.lsiq_id === i.U).orR
+  }
+
   store_req_q.io.enq.valid := sas.io.out.valid
   store_req_q.io.enq.bits.sifq := sas.io.out.bits
   store_req_q.io.enq.bits.request := sas.io.req.bits
@@ -396,6 +421,41 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
     }
   }
 
+  // Store data buffer, holding each store request from issue until its ack
+  las.io.fwd.hit := false.B
+  las.io.fwd.stall := false.B
+  if (vParams.forwardStores) {
+    val sdb_valids = RegInit(VecInit.fill(vParams.vsifqEntries)(false.B))
+    val sdb = Reg(Vec(vParams.vsifqEntries, new Bundle {
+      val block = UInt((coreMaxAddrBits - mLenOffBits).W)
+      val data = UInt(mLen.W)
+      val mask = UInt(mLenB.W)
+    }))
+    def sdbIdx(tag: UInt) = tag(log2Ceil(vParams.vsifqEntries)-1,0)
+    when (store_req.fire) {
+      sdb_valids(sdbIdx(store_req.bits.tag)) := true.B
+      sdb(sdbIdx(store_req.bits.tag)).block := store_req.bits.addr >> mLenOffBits
+      sdb(sdbIdx(store_req.bits.tag)).data := store_req.bits.data
+      sdb(sdbIdx(store_req.bits.tag)).mask := store_req.bits.mask
+    }
+    when (io.dmem.store_ack.valid) {
+      sdb_valids(sdbIdx(io.dmem.store_ack.bits.tag)) := false.B
+    }
+
+    // Only stores that write bytes the load reads matter. Forward when exactly one
+    // does and it covers all of them, otherwise wait for the acks.
+    val las_block = las.io.req.bits.addr >> mLenOffBits
+    val las_mask = las.io.req.bits.mask
+    val sdb_hits = sdb_valids.zip(sdb).map { case (v, e) => v && e.block === las_block && (e.mask & las_mask) =/= 0.U }
+    val sdb_hit = Mux1H(sdb_hits, sdb)
+    val sdb_fwd = PopCount(sdb_hits) === 1.U && (las_mask & ~sdb_hit.mask) === 0.U
+    when (las.io.op.mop === mopUnit) {
+      las.io.fwd.hit := sdb_fwd
+      las.io.fwd.stall := sdb_hits.orR && !sdb_fwd
+    }
+    lifq.io.entry_data := sdb_hit.data
+  }
+
   store_rob.io.push.valid := io.dmem.store_ack.valid
   store_rob.io.push.bits.tag := io.dmem.store_ack.bits.tag
   store_rob.io.push.bits.data := DontCare
@@ -431,4 +491,28 @@ class VectorMemUnit(sgSize: Option[BigInt] = None)(implicit p: Parameters) exten
   io.dmem.load_req.bits.mask := ~(0.U(mLenB.W))
 
   io.busy := liq_valids.orR || siq_valids.orR
+
+  io.perf.load_order_block := liq_las_valid && las_order_block
+  io.perf.store_order_block := siq_sas_valid && sas_order_block
+  io.perf.load_replay := lifq.io.replay.fire
+  io.perf.load_bytes := Mux(las.io.req.fire, PopCount(las.io.req.bits.mask), 0.U)
+  io.perf.load_coalesced := las.io.out.fire && las.io.out.bits.coalesced
+  io.perf.load_forwarded := las.io.out.fire && las.io.out.bits.forwarded
+  io.perf.prefetch_useful := false.B
+  io.perf.prefetch_late := false.B
+  io.perf.prefetch_useless := false.B
+
+  io.prefetch.foreach { pf =>
+    val prefetcher = Module(new StreamPrefetcher)
+    prefetcher.io.load.valid := liq_enq_fire && io.enq.bits.mop === mopUnit
+    prefetcher.io.load.bits.start := Cat(io.enq.bits.page, io.enq.bits.base_offset)
+    prefetcher.io.load.bits.last := Cat(io.enq.bits.page, enq_bound)
+    prefetcher.io.demand.valid := io.dmem.load_req.fire
+    prefetcher.io.demand.bits := io.dmem.load_req.bits.addr
+    pf <> prefetcher.io.mem
+    io.perf.prefetch_useful := prefetcher.io.useful
+    io.perf.prefetch_late := prefetcher.io.late
+    io.perf.prefetch_useless := prefetcher.io.useless
+  }
+  io.perf.store_bytes := Mux(io.dmem.store_req.fire, PopCount(io.dmem.store_req.bits.mask), 0.U)
 }
@@ -0,0 +1,88 @@
+package saturn.mem
+
+import chisel3._
+import chisel3.util._
+import org.chipsalliance.cde.config._
+import freechips.rocketchip.rocket._
+import freechips.rocketchip.util._
+import freechips.rocketchip.tile._
+import saturn.common._
+
+class VectorPrefetchIO(implicit p: Parameters) extends CoreBundle()(p) with HasVectorParams {
+  val req = Decoupled(new Bundle {
+    val addr = UInt(coreMaxAddrBits.W)
+    val tag = UInt(prefetchTagBits.W)
+  })
+  val ack = Input(Valid(UInt(prefetchTagBits.W)))
+}
+
+// Detects unit-stride loads that continue where the previous one ended, and
+// prefetches up to prefetchLines cache lines past the end of the newest one,
+// without crossing its page. Every prefetched line is tracked until a demand
+// request reaches it or a newer prefetch replaces it.
+class StreamPrefetcher(implicit p: Parameters) extends CoreModule()(p) with HasVectorParams {
+  val nLines = vParams.prefetchLines
+  val lineBits = paddrBits - lgCacheBlockBytes
+
+  val io = IO(new Bundle {
+    val load = Input(Valid(new Bundle {
+      val start = UInt(paddrBits.W)
+      val last = UInt(paddrBits.W)
+    }))
+    val demand = Input(Valid(UInt(paddrBits.W)))
+    val mem = new VectorPrefetchIO
+
+    val useful = Output(Bool())
+    val late = Output(Bool())
+    val useless = Output(Bool())
+  })
+
+  val last_valid = RegInit(false.B)
+  val last_line = Reg(UInt(lineBits.W))
+  val active = RegInit(false.B)
+  val next_line = Reg(UInt(lineBits.W))
+  val limit_line = Reg(UInt(lineBits.W))
+
+  when (io.load.valid) {
+    val start_line = io.load.bits.start >> lgCacheBlockBytes
+    val end_line = io.load.bits.last >> lgCacheBlockBytes
+    val page_end_line = Cat(io.load.bits.last >> pgIdxBits, ~(0.U((pgIdxBits - lgCacheBlockBytes).W)))
+    val sequential = last_valid && (start_line === last_line || start_line === last_line + 1.U)
+    last_valid := true.B
+    last_line := end_line
+    active := sequential
+    when (sequential) {
+      next_line := Mux(active && next_line > end_line && next_line <= page_end_line, next_line, end_line + 1.U)
+      limit_line := Mux(end_line +& nLines.U > page_end_line, page_end_line, end_line + nLines.U)
+    }
+  }
+
+  val valids = RegInit(VecInit.fill(nLines)(false.B))
+  val inflight = RegInit(VecInit.fill(nLines)(false.B))
+  val lines = Reg(Vec(nLines, UInt(lineBits.W)))
+  val alloc_ptr = RegInit(0.U(prefetchTagBits.W))
+
+  val demand_line = io.demand.bits >> lgCacheBlockBytes
+  val hits = (0 until nLines).map { i => valids(i) && lines(i) === demand_line }
+  io.useful := io.demand.valid && hits.zip(inflight).map { case (h, f) => h && !f }.orR
+  io.late := io.demand.valid && hits.zip(inflight).map { case (h, f) => h && f }.orR
+  when (io.demand.valid) {
+    for (i <- 0 until nLines) when (hits(i)) { valids(i) := false.B }
+  }
+
+  io.mem.req.valid := active && next_line <= limit_line && !inflight(alloc_ptr) && !io.load.valid
+  io.mem.req.bits.addr := next_line << lgCacheBlockBytes
+  io.mem.req.bits.tag := alloc_ptr
+
+  io.useless := io.mem.req.fire && valids(alloc_ptr)
+  when (io.mem.req.fire) {
+    valids(alloc_ptr) := true.B
+    inflight(alloc_ptr) := true.B
+    lines(alloc_ptr) := next_line
+    alloc_ptr := Mux(alloc_ptr === (nLines - 1).U, 0.U, alloc_ptr + 1.U)
+    next_line := next_line + 1.U
+  }
+  when (io.mem.ack.valid) {
+    inflight(io.mem.ack.bits) := false.B
+  }
+}
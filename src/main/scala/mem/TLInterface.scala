@@ -11,7 +11,7 @@ import freechips.rocketchip.diplomacy._
 
 import saturn.common._
 
-class TLInterface(tagBits: Int)(implicit p: Parameters) extends LazyModule()(p) with HasCoreParameters {
+class TLInterface(tagBits: Int, combineLines: Boolean = false)(implicit p: Parameters) extends LazyModule()(p) with HasCoreParameters {
   val node = TLClientNode(Seq(TLMasterPortParameters.v1(Seq(TLMasterParameters.v1(
     name      = s"Core ${tileId} Vector Load",
     sourceId  = IdRange(0, 1 << tagBits)
@@ -30,39 +30,161 @@ class TLInterface(tagBits: Int)(implicit p: Parameters) extends LazyModule()(p)
       val resp = Valid(new MemResponse(widthBytes, tagBits))
     })
 
-    val inflights = RegInit(0.U(tagBits.W))
-    when (out.a.fire || out.d.fire) {
-      inflights := inflights + out.a.fire - out.d.fire
+    if (!combineLines) {
+      val inflights = RegInit(0.U(tagBits.W))
+      when (out.a.fire || out.d.fire) {
+        inflights := inflights + out.a.fire - out.d.fire
+      }
+      io.busy := inflights =/= 0.U
+
+      io.req.ready := out.a.ready
+      out.a.valid := io.req.valid
+      out.a.bits := Mux(io.req.bits.store,
+        edge.Put(
+          io.req.bits.tag,
+          (io.req.bits.addr >> offBits) << offBits,
+          log2Ceil(widthBytes).U,
+          io.req.bits.data,
+          io.req.bits.mask)._2,
+        edge.Get(
+          io.req.bits.tag,
+          (io.req.bits.addr >> offBits) << offBits,
+          log2Ceil(widthBytes).U)._2
+      )
+
+      out.d.ready := true.B
+      io.resp.valid := out.d.valid
+      io.resp.bits.data := out.d.bits.data
+      io.resp.bits.tag := out.d.bits.source
+    } else {
+      // Write combining for stores. Beats to the same cache line collect in a
+      // line buffer, which is written out as one burst: a PutFullData once every
+      // byte is written, otherwise a PutPartialData when a store to another line
+      // arrives or no store has arrived for combineIdleCycles. The burst reuses
+      // a free source id, and its AccessAck acknowledges every beat it carried.
+      val lineBytes = 1 << lgCacheBlockBytes
+      val nBeats = lineBytes / widthBytes
+      val nTags = 1 << tagBits
+      val combineIdleCycles = 16
+      require(lineBytes >= widthBytes)
+
+      val buf_valid = RegInit(false.B)
+      val buf_line = Reg(UInt((coreMaxAddrBits - lgCacheBlockBytes).W))
+      val buf_data = Reg(Vec(lineBytes, UInt(8.W)))
+      val buf_mask = RegInit(0.U(lineBytes.W))
+      val buf_tags = RegInit(0.U(nTags.W))
+      val idle = RegInit(0.U(log2Ceil(combineIdleCycles + 1).W))
+
+      val sending = RegInit(false.B)
+      val send_beat = RegInit(0.U(log2Ceil(nBeats max 2).W))
+      val send_source = Reg(UInt(tagBits.W))
+      val src_busy = RegInit(0.U(nTags.W))
+      val src_tags = Reg(Vec(nTags, UInt(nTags.W)))
+      val ack_pending = RegInit(0.U(nTags.W))
+
+      val req_line = io.req.bits.addr >> lgCacheBlockBytes
+      val req_offset = (if (nBeats > 1) io.req.bits.addr(lgCacheBlockBytes-1,offBits) else 0.U) << offBits
+      val merge = !buf_valid || buf_line === req_line
+      io.req.ready := !sending && merge
+
+      when (io.req.fire) {
+        for (i <- 0 until widthBytes) {
+          when (io.req.bits.mask(i)) { buf_data(req_offset + i.U) := io.req.bits.data(i*8+7,i*8) }
+        }
+        buf_valid := true.B
+        buf_line := req_line
+        buf_mask := buf_mask | (io.req.bits.mask << req_offset)
+        buf_tags := buf_tags | UIntToOH(io.req.bits.tag)
+        idle := 0.U
+      } .elsewhen (buf_valid && idle =/= combineIdleCycles.U) {
+        idle := idle + 1.U
+      }
+
+      val free_source = PriorityEncoder(~src_busy)
+      val flush = buf_valid && !sending && !src_busy.andR && !io.req.fire && (
+        buf_mask.andR || (io.req.valid && !merge) || idle === combineIdleCycles.U)
+      when (flush) {
+        sending := true.B
+        send_beat := 0.U
+        send_source := free_source
+      }
+
+      val full = buf_mask.andR
+      val beat_addr = buf_line << lgCacheBlockBytes
+      val beat_data = buf_data.asUInt >> (send_beat << (offBits + 3))
+      val beat_mask = buf_mask >> (send_beat << offBits)
+      out.a.valid := sending
+      out.a.bits := Mux(full,
+        edge.Put(send_source, beat_addr, lgCacheBlockBytes.U, beat_data(widthBytes*8-1,0))._2,
+        edge.Put(send_source, beat_addr, lgCacheBlockBytes.U, beat_data(widthBytes*8-1,0), beat_mask(widthBytes-1,0))._2)
+
+      val last_beat = send_beat === (nBeats - 1).U
+      when (out.a.fire) {
+        send_beat := send_beat + 1.U
+        when (last_beat) {
+          sending := false.B
+          buf_valid := false.B
+          buf_mask := 0.U
+          buf_tags := 0.U
+          src_tags(send_source) := buf_tags
+        }
+      }
+
+      out.d.ready := true.B
+      val src_set = Mux(out.a.fire && last_beat, UIntToOH(send_source), 0.U)
+      val src_clr = Mux(out.d.fire, UIntToOH(out.d.bits.source), 0.U)
+      src_busy := (src_busy | src_set) & ~src_clr
+
+      io.resp.valid := ack_pending.orR
+      io.resp.bits.data := DontCare
+      io.resp.bits.tag := PriorityEncoder(ack_pending)
+      val ack_set = Mux(out.d.fire, src_tags(out.d.bits.source), 0.U)
+      val ack_clr = Mux(io.resp.valid, UIntToOH(io.resp.bits.tag), 0.U)
+      ack_pending := (ack_pending & ~ack_clr) | ack_set
+
+      io.busy := buf_valid || sending || src_busy.orR || ack_pending.orR
     }
-    io.busy := inflights =/= 0.U
-
-    io.req.ready := out.a.ready
-    out.a.valid := io.req.valid
-    out.a.bits := Mux(io.req.bits.store,
-      edge.Put(
-        io.req.bits.tag,
-        (io.req.bits.addr >> offBits) << offBits,
-        log2Ceil(widthBytes).U,
-        io.req.bits.data,
-        io.req.bits.mask)._2,
-      edge.Get(
-        io.req.bits.tag,
-        (io.req.bits.addr >> offBits) << offBits,
-        log2Ceil(widthBytes).U)._2
-    )
+  }
+}
+
+
+// Issues cache-line prefetch Hints. Hints the managers cannot take are
+// acknowledged right away instead.
+class TLPrefetchInterface(tagBits: Int)(implicit p: Parameters) extends LazyModule()(p) with HasCoreParameters {
+  val node = TLClientNode(Seq(TLMasterPortParameters.v1(Seq(TLMasterParameters.v1(
+    name      = s"Core ${tileId} Vector Prefetch",
+    sourceId  = IdRange(0, 1 << tagBits)
+  )))))
+  override lazy val module = new Impl
+  class Impl extends LazyModuleImp(this) {
+
+    val (out, edge) = node.out(0)
+
+    val io = IO(new Bundle {
+      val req = Flipped(Decoupled(new Bundle {
+        val addr = UInt(coreMaxAddrBits.W)
+        val tag = UInt(tagBits.W)
+      }))
+      val ack = Valid(UInt(tagBits.W))
+    })
+
+    val (legal, hint) = edge.Hint(io.req.bits.tag, io.req.bits.addr, lgCacheBlockBytes.U, TLHints.PREFETCH_READ)
+
+    out.a.valid := io.req.valid && legal
+    out.a.bits := hint
+    io.req.ready := Mux(legal, out.a.ready, !out.d.valid)
 
     out.d.ready := true.B
-    io.resp.valid := out.d.valid
-    io.resp.bits.data := out.d.bits.data
-    io.resp.bits.tag := out.d.bits.source
+    io.ack.valid := out.d.valid || (io.req.valid && !legal)
+    io.ack.bits := Mux(out.d.valid, out.d.bits.source, io.req.bits.tag)
   }
 }
 
-
 class TLSplitInterface(implicit p: Parameters) extends LazyModule()(p) with HasCoreParameters with HasVectorParams {
 
   val reader = LazyModule(new TLInterface(dmemTagBits))
-  val writer = LazyModule(new TLInterface(dmemTagBits))
+  val writer = LazyModule(new TLInterface(dmemTagBits, vParams.streamingStores))
+  val prefetcher = Option.when(vParams.prefetchLines > 0)(LazyModule(new TLPrefetchInterface(prefetchTagBits)))
 
   val arb = LazyModule(new TLXbar)
   def node = TLWidthWidget(mLenB) := arb.node
@@ -70,11 +192,13 @@ class TLSplitInterface(implicit p: Parameters) extends LazyModule()(p) with HasC
 
   arb.node := reader.node
   arb.node := writer.node
+  prefetcher.foreach { arb.node := _.node }
 
   override lazy val module = new Impl
   class Impl extends LazyModuleImp(this) {
     val io = IO(new Bundle {
       val vec = Flipped(new VectorMemIO)
+      val prefetch = prefetcher.map(_ => Flipped(new VectorPrefetchIO))
       val mem_busy = Output(Bool())
     })
 
@@ -83,5 +207,9 @@ class TLSplitInterface(implicit p: Parameters) extends LazyModule()(p) with HasC
     writer.module.io.req <> io.vec.store_req
     io.vec.store_ack <> writer.module.io.resp
     io.mem_busy := reader.module.io.busy || writer.module.io.busy
+    prefetcher.foreach { pf =>
+      pf.module.io.req <> io.prefetch.get.req
+      io.prefetch.get.ack := pf.module.io.ack
+    }
   }
 }
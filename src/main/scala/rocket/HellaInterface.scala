@@ -53,7 +53,7 @@ class HellaCacheInterface(implicit p: Parameters) extends CoreModule()(p) with H
   hella_load_q.io.enq.bits.dv     := io.status.dv
   hella_load_q.io.enq.bits.data   := DontCare
   hella_load_q.io.enq.bits.mask   := DontCare
-  hella_load_q.io.enq.bits.phys   := false.B
+  hella_load_q.io.enq.bits.phys   := true.B // VMU addresses are already translated
   hella_load_q.io.enq.bits.no_resp := false.B
   hella_load_q.io.enq.bits.no_alloc := false.B
   hella_load_q.io.enq.bits.no_xcpt := true.B
@@ -73,9 +73,9 @@ class HellaCacheInterface(implicit p: Parameters) extends CoreModule()(p) with H
   hella_store_q.io.enq.bits.dv     := io.status.dv
   hella_store_q.io.enq.bits.data   := io.vec.store_req.bits.data
   hella_store_q.io.enq.bits.mask   := io.vec.store_req.bits.mask
-  hella_store_q.io.enq.bits.phys   := false.B
+  hella_store_q.io.enq.bits.phys   := true.B // VMU addresses are already translated
   hella_store_q.io.enq.bits.no_resp := false.B
-  hella_store_q.io.enq.bits.no_alloc := false.B
+  hella_store_q.io.enq.bits.no_alloc := vParams.streamingStores.B
   hella_store_q.io.enq.bits.no_xcpt := true.B
 
   io.vec.store_ack.valid := hella_store.resp.valid
@@ -50,6 +50,7 @@ class SaturnRocketUnit(implicit p: Parameters) extends RocketVectorUnit()(p) wit
     vu.io.vmu <> vmu.io.vu
     vu.io.vat_tail := dis.io.vat_tail
     vu.io.vat_head := dis.io.vat_head
+    vu.io.vrf_home := dis.io.vrf_home
     vu.io.dis <> dis.io.dis
     dis.io.vat_release := vu.io.vat_release
     vmu.io.enq <> dis.io.mem
@@ -60,6 +61,13 @@ class SaturnRocketUnit(implicit p: Parameters) extends RocketVectorUnit()(p) wit
     io.core.set_vxsat      := vu.io.set_vxsat
     io.core.set_fflags     := vu.io.set_fflags
 
+    // Per-cycle event counts, in VectorPerfEvents order. The core does not
+    // add these to its HPM event sets, so they are only visible to the
+    // enclosing design and in simulation
+    val perf_events = VectorPerfEvents(vu.perf, vmu.io.perf, vu.allSeqNames)
+    val perf = IO(Output(MixedVec(perf_events.map(e => UInt(e._2.getWidth.W)))))
+    perf.zip(perf_events).foreach { case (port, (_, e)) => port := e }
+
     scalar_arb.io.in(0) <> vu.io.scalar_resp
     scalar_arb.io.in(1) <> dis.io.scalar_resp
     io.core.resp <> Queue(scalar_arb.io.out)
@@ -81,12 +89,10 @@ class SaturnRocketUnit(implicit p: Parameters) extends RocketVectorUnit()(p) wit
       out
     }
 
-    val load_use_tl_reg = RegInit(true.B)
-    val store_use_tl_reg = RegInit(true.B)
-
-    // virtually-addressed requests must go through L1
-    val load_use_tl = load_use_tl_reg || !useL1DCache.B
-    val store_use_tl = store_use_tl_reg || !useL1DCache.B
+    // Each request picks a port from its macro-op. A request waits for the
+    // other port to drain first, so accesses on the two ports never reorder.
+    val load_use_tl = !vmu.io.dmem.load_req.bits.l1 || !useL1DCache.B
+    val store_use_tl = !vmu.io.dmem.store_req.bits.l1 || !useL1DCache.B
 
     vmu.io.dmem.load_resp.valid := tl_if.module.io.vec.load_resp.valid || hella_if.io.vec.load_resp.valid
     vmu.io.dmem.load_resp.bits := Mux1H(
@@ -97,6 +103,8 @@ class SaturnRocketUnit(implicit p: Parameters) extends RocketVectorUnit()(p) wit
       Seq(tl_if.module.io.vec.store_ack.valid, hella_if.io.vec.store_ack.valid),
       Seq(tl_if.module.io.vec.store_ack.bits , hella_if.io.vec.store_ack.bits))
 
+    vmu.io.prefetch.foreach { _ <> tl_if.module.io.prefetch.get }
+
     when (load_use_tl) {
       tl_if.module.io.vec.load_req <> block(vmu.io.dmem.load_req, hella_if.io.mem_busy)
       hella_if.io.vec.load_req.valid := false.B
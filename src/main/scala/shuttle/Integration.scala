@@ -53,6 +53,7 @@ class SaturnShuttleUnit(implicit p: Parameters) extends ShuttleVectorUnit()(p) w
     vu.io.vmu <> vmu.io.vu
     vu.io.vat_tail := dis.io.vat_tail
     vu.io.vat_head := dis.io.vat_head
+    vu.io.vrf_home := dis.io.vrf_home
     vu.io.dis <> dis.io.dis
     dis.io.vat_release := vu.io.vat_release
     vmu.io.enq <> dis.io.mem
@@ -63,12 +64,20 @@ class SaturnShuttleUnit(implicit p: Parameters) extends ShuttleVectorUnit()(p) w
     io.set_vxsat      := vu.io.set_vxsat
     io.set_fflags     := vu.io.set_fflags
 
+    // Per-cycle event counts, in VectorPerfEvents order. The core does not
+    // add these to its HPM event sets, so they are only visible to the
+    // enclosing design and in simulation
+    val perf_events = VectorPerfEvents(vu.perf, vmu.io.perf, vu.allSeqNames)
+    val perf = IO(Output(MixedVec(perf_events.map(e => UInt(e._2.getWidth.W)))))
+    perf.zip(perf_events).foreach { case (port, (_, e)) => port := e }
+
 
     scalar_arb.io.in(0) <> vu.io.scalar_resp
     scalar_arb.io.in(1) <> dis.io.scalar_resp
     io.resp <> Queue(scalar_arb.io.out)
 
     tl_if.module.io.vec <> vmu.io.dmem
+    vmu.io.prefetch.foreach { _ <> tl_if.module.io.prefetch.get }
 
     vu.io.fp_req.ready := false.B
     vu.io.fp_resp.valid := false.B